@@ -0,0 +1,150 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <random>
+#include <numeric>
+#include <absl/algorithm/container.h>
+#include "../sfizz/SIMDHelpers.h"
+
+// Interpolates a source at the positions of a random playback speed, as the
+// voices do after computing their indices and coefficients, for each
+// interpolation tier.
+
+constexpr float maxJump { 4 };
+
+class Interpolate : public benchmark::Fixture {
+public:
+  void SetUp(const ::benchmark::State& state) {
+    std::random_device rd { };
+    std::mt19937 gen { rd() };
+    std::uniform_real_distribution<float> dist { 0, maxJump };
+    std::uniform_real_distribution<float> sourceDist { -1, 1 };
+    const auto size = static_cast<size_t>(state.range(0));
+    indices = std::vector<int>(size);
+    leftCoeffs = std::vector<float>(size);
+    rightCoeffs = std::vector<float>(size);
+    outputLeft = std::vector<float>(size);
+    outputRight = std::vector<float>(size);
+    jumps = std::vector<float>(size);
+    sourceLeft = std::vector<float>(static_cast<size_t>(maxJump) * size + 2);
+    sourceRight = std::vector<float>(static_cast<size_t>(maxJump) * size + 2);
+    absl::c_generate(jumps, [&]() { return dist(gen); });
+    absl::c_generate(sourceLeft, [&]() { return sourceDist(gen); });
+    absl::c_generate(sourceRight, [&]() { return sourceDist(gen); });
+    sfz::saturatingSFZIndex<float>(jumps, absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), 0.0f, static_cast<float>(sourceLeft.size() - 1));
+  }
+
+  void TearDown(const ::benchmark::State& state [[maybe_unused]]) {
+
+  }
+
+    std::vector<int> indices;
+    std::vector<float> leftCoeffs;
+    std::vector<float> rightCoeffs;
+    std::vector<float> jumps;
+    std::vector<float> sourceLeft;
+    std::vector<float> sourceRight;
+    std::vector<float> outputLeft;
+    std::vector<float> outputRight;
+};
+
+BENCHMARK_DEFINE_F(Interpolate, Mono_Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::linearInterpolation<float, false>(sourceLeft, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(outputLeft));
+        benchmark::DoNotOptimize(outputLeft);
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Mono_SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::linearInterpolation<float, true>(sourceLeft, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(outputLeft));
+        benchmark::DoNotOptimize(outputLeft);
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Stereo_Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::linearInterpolation<float, false>(sourceLeft, sourceRight, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(outputLeft), absl::MakeSpan(outputRight));
+        benchmark::DoNotOptimize(outputLeft);
+        benchmark::DoNotOptimize(outputRight);
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Stereo_SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::linearInterpolation<float, true>(sourceLeft, sourceRight, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(outputLeft), absl::MakeSpan(outputRight));
+        benchmark::DoNotOptimize(outputLeft);
+        benchmark::DoNotOptimize(outputRight);
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Hermite_Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::hermiteInterpolation<float, false>(sourceLeft, indices, rightCoeffs, absl::MakeSpan(outputLeft));
+        benchmark::DoNotOptimize(outputLeft);
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Hermite_SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::hermiteInterpolation<float, true>(sourceLeft, indices, rightCoeffs, absl::MakeSpan(outputLeft));
+        benchmark::DoNotOptimize(outputLeft);
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Sinc_Scalar)(benchmark::State& state) {
+    const auto taps = static_cast<int>(state.range(1));
+    for (auto _ : state)
+    {
+        sfz::sincInterpolation<float, false>(sourceLeft, indices, rightCoeffs, absl::MakeSpan(outputLeft), taps);
+        benchmark::DoNotOptimize(outputLeft);
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Sinc_SIMD)(benchmark::State& state) {
+    const auto taps = static_cast<int>(state.range(1));
+    for (auto _ : state)
+    {
+        sfz::sincInterpolation<float, true>(sourceLeft, indices, rightCoeffs, absl::MakeSpan(outputLeft), taps);
+        benchmark::DoNotOptimize(outputLeft);
+    }
+}
+
+// Register the function as a benchmark
+BENCHMARK_REGISTER_F(Interpolate, Mono_Scalar)->RangeMultiplier(2)->Range((2<<6), (2<<12));
+BENCHMARK_REGISTER_F(Interpolate, Mono_SIMD)->RangeMultiplier(2)->Range((2<<6), (2<<12));
+BENCHMARK_REGISTER_F(Interpolate, Stereo_Scalar)->RangeMultiplier(2)->Range((2<<6), (2<<12));
+BENCHMARK_REGISTER_F(Interpolate, Stereo_SIMD)->RangeMultiplier(2)->Range((2<<6), (2<<12));
+BENCHMARK_REGISTER_F(Interpolate, Hermite_Scalar)->RangeMultiplier(2)->Range((2<<6), (2<<12));
+BENCHMARK_REGISTER_F(Interpolate, Hermite_SIMD)->RangeMultiplier(2)->Range((2<<6), (2<<12));
+BENCHMARK_REGISTER_F(Interpolate, Sinc_Scalar)->RangeMultiplier(2)->Ranges({ { (2<<6), (2<<12) }, { 8, 16 } });
+BENCHMARK_REGISTER_F(Interpolate, Sinc_SIMD)->RangeMultiplier(2)->Ranges({ { (2<<6), (2<<12) }, { 8, 16 } });
+BENCHMARK_MAIN();
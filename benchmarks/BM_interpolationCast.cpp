@@ -28,7 +28,10 @@
 #include <absl/algorithm/container.h>
 #include "../sfizz/SIMDHelpers.h"
 
-// In this one we have an array of jumps
+// In this one we have an array of jumps.
+// The CumsumCast and FixedPoint benchmarks compare the two ways of getting the
+// indices of a constant speed playback: a float cumsum of the jumps followed by
+// the cast, or a 32.32 fixed point phase accumulator.
 
 constexpr float maxJump { 4 };
 
@@ -84,10 +87,41 @@ BENCHMARK_DEFINE_F(InterpolationCast, SIMD_Unaligned)(benchmark::State& state) {
     }
 }
 
+BENCHMARK_DEFINE_F(InterpolationCast, CumsumCast)(benchmark::State& state) {
+    std::vector<float> positions(state.range(0));
+    for (auto _ : state)
+    {
+        sfz::fill<float>(absl::MakeSpan(positions), 1.0594631f);
+        sfz::cumsum<float>(positions, absl::MakeSpan(positions));
+        sfz::sfzInterpolationCast<float>(positions, absl::MakeSpan(jumps), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+        benchmark::DoNotOptimize(jumps);
+    }
+}
+
+BENCHMARK_DEFINE_F(InterpolationCast, FixedPoint_Scalar)(benchmark::State& state) {
+    const auto step = sfz::toFixedPoint(1.0594631f);
+    for (auto _ : state)
+    {
+        sfz::fixedPointIndex<float, false>(absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(jumps), 0, step);
+        benchmark::DoNotOptimize(jumps);
+    }
+}
+
+BENCHMARK_DEFINE_F(InterpolationCast, FixedPoint_SIMD)(benchmark::State& state) {
+    const auto step = sfz::toFixedPoint(1.0594631f);
+    for (auto _ : state)
+    {
+        sfz::fixedPointIndex<float, true>(absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(jumps), 0, step);
+        benchmark::DoNotOptimize(jumps);
+    }
+}
 
 // Register the function as a benchmark
 BENCHMARK_REGISTER_F(InterpolationCast, Scalar)->RangeMultiplier(2)->Range((2<<6), (2<<12));
 BENCHMARK_REGISTER_F(InterpolationCast, SIMD)->RangeMultiplier(2)->Range((2<<6), (2<<12));
 BENCHMARK_REGISTER_F(InterpolationCast, Scalar_Unaligned)->RangeMultiplier(2)->Range((2<<6), (2<<12));
 BENCHMARK_REGISTER_F(InterpolationCast, SIMD_Unaligned)->RangeMultiplier(2)->Range((2<<6), (2<<12));
+BENCHMARK_REGISTER_F(InterpolationCast, CumsumCast)->RangeMultiplier(2)->Range((2<<6), (2<<12));
+BENCHMARK_REGISTER_F(InterpolationCast, FixedPoint_Scalar)->RangeMultiplier(2)->Range((2<<6), (2<<12));
+BENCHMARK_REGISTER_F(InterpolationCast, FixedPoint_SIMD)->RangeMultiplier(2)->Range((2<<6), (2<<12));
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+#include "BenchmarkHelpers.h"
+#include "Synth.h"
+#include "ghc/fs_std.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Load an instrument made of many distinct files, with a growing number of loading
+// threads; the files are opened, read and preloaded in parallel. Velocity layers
+// reference each file from several regions, some of them with an offset.
+
+constexpr int numFiles { 256 };
+constexpr int numLayers { 4 };
+
+class LoadFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state [[maybe_unused]])
+    {
+        directory = fs::temp_directory_path() / "sfizz_bm_load";
+        fs::create_directories(directory);
+        sfzFile = directory / "instrument.sfz";
+        std::ofstream sfz { sfzFile.string() };
+        for (int file = 0; file < numFiles; ++file) {
+            const auto wavFile = "sample" + std::to_string(file) + ".wav";
+            writeSineWave(directory / wavFile, 2 * sfz::config::preloadSize);
+            for (int layer = 0; layer < numLayers; ++layer)
+                sfz << "<region> key=" << file % 128 << " lovel=" << 32 * layer << " hivel=" << 32 * layer + 31
+                    << " sample=" << wavFile << " offset=" << 100 * layer << "\n";
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state [[maybe_unused]])
+    {
+        fs::remove_all(directory);
+    }
+
+    fs::path directory;
+    fs::path sfzFile;
+};
+
+BENCHMARK_DEFINE_F(LoadFixture, LoadSfzFile)(benchmark::State& state)
+{
+    for (auto _ : state) {
+        sfz::Synth synth;
+        synth.setNumLoadingThreads(static_cast<int>(state.range(0)));
+        synth.loadSfzFile(sfzFile);
+        benchmark::DoNotOptimize(synth.getNumPreloadedSamples());
+    }
+    state.counters["Files"] = benchmark::Counter(numFiles, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void threadArguments(benchmark::internal::Benchmark* benchmark)
+{
+    const auto maxThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    for (int numThreads = 1; numThreads <= std::max(maxThreads, 8); numThreads *= 2)
+        benchmark->Arg(numThreads);
+}
+
+BENCHMARK_REGISTER_F(LoadFixture, LoadSfzFile)->Apply(threadArguments)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_MAIN();
@@ -90,7 +90,23 @@ BENCHMARK_DEFINE_F(PanArray, BlockOps)(benchmark::State& state) {
     }
 }
 
+BENCHMARK_DEFINE_F(PanArray, PanLawScalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::panLaw<float, false>(pan, span1, span2);
+    }
+}
+
+BENCHMARK_DEFINE_F(PanArray, PanLawSIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::panLaw<float, true>(pan, span1, span2);
+    }
+}
+
 BENCHMARK_REGISTER_F(PanArray, Scalar)->RangeMultiplier(4)->Range(1 << 2, 1 << 12);
 BENCHMARK_REGISTER_F(PanArray, SIMD)->RangeMultiplier(4)->Range(1 << 2, 1 << 12);
 BENCHMARK_REGISTER_F(PanArray, BlockOps)->RangeMultiplier(4)->Range(1 << 2, 1 << 12);
+BENCHMARK_REGISTER_F(PanArray, PanLawScalar)->RangeMultiplier(4)->Range(1 << 2, 1 << 12);
+BENCHMARK_REGISTER_F(PanArray, PanLawSIMD)->RangeMultiplier(4)->Range(1 << 2, 1 << 12);
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,318 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+#include "BenchmarkHelpers.h"
+#include "Synth.h"
+#include "ghc/fs_std.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+// Render a full block with a varying number of sounding voices; the cost should
+// follow the number of active voices and not the size of the voice pool.
+// The Threads benchmark renders a full voice pool with a growing number of threads.
+// The NoteStorm benchmark fires 1000 notes per second at full polyphony, so that
+// every note has to steal a voice.
+// The ShortLoops benchmark plays sampled voices on very short loops with high pitch
+// ratios, which wrap around the loop several times per block or even per frame.
+// The SampleQuality benchmark renders transposed looping voices for each interpolation
+// quality tier; the PerVoice counter gives the cost of a voice for a block.
+// The Generators benchmark renders each generator (sine, saw, noise) over the
+// same 4 octaves, to compare the cost of a wavetable voice with a sampled one.
+// The Streaming benchmark plays 128 voices on a sample much longer than the preloaded
+// data, paced in real time, while the disk is throttled to a read rate in MB/s (0 is
+// unthrottled); Underruns counts the quanta per block where a voice ran out of data.
+// The second argument streams from a memory mapping of the file instead of libsndfile.
+
+constexpr int blockSize { 1024 };
+
+class RenderFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto sfzFile = fs::temp_directory_path() / "sfizz_bm_render.sfz";
+        std::ofstream { sfzFile.string() } << "<region> sample=*sine\n";
+        synth = std::make_unique<sfz::Synth>();
+        synth->setSamplesPerBlock(blockSize);
+        synth->loadSfzFile(sfzFile);
+        for (int note = 0; note < state.range(0); ++note)
+            synth->noteOn(0, 1, note, 64);
+        fs::remove(sfzFile);
+    }
+
+    void TearDown(const ::benchmark::State& state [[maybe_unused]])
+    {
+        synth.reset();
+    }
+
+    std::unique_ptr<sfz::Synth> synth;
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+};
+
+BENCHMARK_DEFINE_F(RenderFixture, ActiveVoices)(benchmark::State& state)
+{
+    for (auto _ : state) {
+        synth->renderBlock(buffer);
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.counters["Voices"] = synth->getNumActiveVoices();
+}
+
+BENCHMARK_DEFINE_F(RenderFixture, Threads)(benchmark::State& state)
+{
+    synth->setNumThreads(static_cast<int>(state.range(1)));
+    for (auto _ : state) {
+        synth->renderBlock(buffer);
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.counters["Voices"] = synth->getNumActiveVoices();
+    state.counters["Threads"] = synth->getNumThreads();
+}
+
+BENCHMARK_DEFINE_F(RenderFixture, NoteStorm)(benchmark::State& state)
+{
+    const int notesPerBlock = static_cast<int>(1000 * blockSize / sfz::config::defaultSampleRate);
+    int note = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < notesPerBlock; ++i) {
+            const auto delay = i * blockSize / notesPerBlock;
+            // Release every other note so that both released and playing voices get stolen
+            if (i % 2 == 0)
+                synth->noteOff(delay, 1, (note + 64) % 128, 0);
+            synth->noteOn(delay, 1, note, 64);
+            note = (note + 1) % 128;
+        }
+        synth->renderBlock(buffer);
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.counters["Voices"] = synth->getNumActiveVoices();
+    state.counters["Notes"] = benchmark::Counter(notesPerBlock, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void threadArguments(benchmark::internal::Benchmark* benchmark)
+{
+    const auto maxThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+        benchmark->Args({ sfz::config::numVoices, numThreads });
+    if ((maxThreads & (maxThreads - 1)) != 0)
+        benchmark->Args({ sfz::config::numVoices, maxThreads });
+}
+
+class LoopFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto directory = fs::temp_directory_path();
+        wavFile = directory / "sfizz_bm_loop.wav";
+        const auto sfzFile = directory / "sfizz_bm_loop.sfz";
+        writeSineWave(wavFile, 4096);
+        // Notes are played above the key center, with pitch ratios between 1 and 8
+        const auto loopStart = 1024;
+        std::ofstream { sfzFile.string() } << "<region> sample=" << wavFile.filename().string()
+                                           << " pitch_keycenter=24 loop_mode=loop_continuous"
+                                           << " loop_start=" << loopStart
+                                           << " loop_end=" << loopStart + state.range(0) << "\n";
+        synth = std::make_unique<sfz::Synth>();
+        synth->setSamplesPerBlock(blockSize);
+        synth->loadSfzFile(sfzFile);
+        for (int note = 24; note < 60; ++note)
+            synth->noteOn(0, 1, note, 64);
+        fs::remove(sfzFile);
+    }
+
+    void TearDown(const ::benchmark::State& state [[maybe_unused]])
+    {
+        synth.reset();
+        fs::remove(wavFile);
+    }
+
+    fs::path wavFile;
+    std::unique_ptr<sfz::Synth> synth;
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+};
+
+BENCHMARK_DEFINE_F(LoopFixture, ShortLoops)(benchmark::State& state)
+{
+    for (auto _ : state) {
+        synth->renderBlock(buffer);
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.counters["Voices"] = synth->getNumActiveVoices();
+}
+
+class QualityFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto directory = fs::temp_directory_path();
+        wavFile = directory / "sfizz_bm_quality.wav";
+        const auto sfzFile = directory / "sfizz_bm_quality.sfz";
+        writeSineWave(wavFile, 4096);
+        std::ofstream { sfzFile.string() } << "<region> sample=" << wavFile.filename().string()
+                                           << " pitch_keycenter=48 loop_mode=loop_continuous"
+                                           << " loop_start=0 loop_end=4095\n";
+        synth = std::make_unique<sfz::Synth>();
+        synth->setSamplesPerBlock(blockSize);
+        synth->setSampleQuality(static_cast<int>(state.range(0)));
+        synth->loadSfzFile(sfzFile);
+        // Spread the voices over 2 octaves on each side of the key center
+        const auto numVoices = static_cast<int>(state.range(1));
+        for (int voice = 0; voice < numVoices; ++voice)
+            synth->noteOn(0, 1, 24 + (voice * 48) / numVoices, 64);
+        fs::remove(sfzFile);
+    }
+
+    void TearDown(const ::benchmark::State& state [[maybe_unused]])
+    {
+        synth.reset();
+        fs::remove(wavFile);
+    }
+
+    fs::path wavFile;
+    std::unique_ptr<sfz::Synth> synth;
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+};
+
+BENCHMARK_DEFINE_F(QualityFixture, SampleQuality)(benchmark::State& state)
+{
+    for (auto _ : state) {
+        synth->renderBlock(buffer);
+        benchmark::DoNotOptimize(buffer);
+    }
+    const auto numVoices = synth->getNumActiveVoices();
+    state.counters["Voices"] = numVoices;
+    state.counters["PerVoice"] = benchmark::Counter(numVoices,
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+// One entry per interpolation tier: linear, Hermite, 8-tap and 16-tap sinc
+static void qualityArguments(benchmark::internal::Benchmark* benchmark)
+{
+    for (int quality : { 1, 2, 3, 6 })
+        for (int numVoices : { 8, 32 })
+            benchmark->Args({ quality, numVoices });
+}
+
+class GeneratorFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        const char* generators[] { "*sine", "*saw", "*noise" };
+        const auto sfzFile = fs::temp_directory_path() / "sfizz_bm_generator.sfz";
+        std::ofstream { sfzFile.string() } << "<region> sample=" << generators[state.range(0)] << "\n";
+        synth = std::make_unique<sfz::Synth>();
+        synth->setSamplesPerBlock(blockSize);
+        synth->loadSfzFile(sfzFile);
+        const auto numVoices = static_cast<int>(state.range(1));
+        for (int voice = 0; voice < numVoices; ++voice)
+            synth->noteOn(0, 1, 24 + (voice * 48) / numVoices, 64);
+        fs::remove(sfzFile);
+    }
+
+    void TearDown(const ::benchmark::State& state [[maybe_unused]])
+    {
+        synth.reset();
+    }
+
+    std::unique_ptr<sfz::Synth> synth;
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+};
+
+BENCHMARK_DEFINE_F(GeneratorFixture, Generators)(benchmark::State& state)
+{
+    for (auto _ : state) {
+        synth->renderBlock(buffer);
+        benchmark::DoNotOptimize(buffer);
+    }
+    const auto numVoices = synth->getNumActiveVoices();
+    state.counters["Voices"] = numVoices;
+    state.counters["PerVoice"] = benchmark::Counter(numVoices,
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+class StreamFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto directory = fs::temp_directory_path();
+        wavFile = directory / "sfizz_bm_stream.wav";
+        const auto sfzFile = directory / "sfizz_bm_stream.sfz";
+        writeSineWave(wavFile, 20 * 44100);
+        std::ofstream { sfzFile.string() } << "<region> sample=" << wavFile.filename().string()
+                                           << " pitch_keytrack=0\n";
+        synth = std::make_unique<sfz::Synth>();
+        synth->setNumVoices(numVoices);
+        synth->setSamplesPerBlock(blockSize);
+        synth->setStreamingReadRate(1e6 * static_cast<double>(state.range(0)));
+        synth->setMemoryMappedStreaming(state.range(1) != 0);
+        synth->loadSfzFile(sfzFile);
+        for (int voice = 0; voice < numVoices; ++voice)
+            synth->noteOn(0, 1, voice, 64);
+        fs::remove(sfzFile);
+    }
+
+    void TearDown(const ::benchmark::State& state [[maybe_unused]])
+    {
+        synth.reset();
+        fs::remove(wavFile);
+    }
+
+    static constexpr int numVoices { 128 };
+    fs::path wavFile;
+    std::unique_ptr<sfz::Synth> synth;
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+};
+
+BENCHMARK_DEFINE_F(StreamFixture, Streaming)(benchmark::State& state)
+{
+    // The loading thread gets the time left in each block, as in a real-time host
+    const auto blockDuration = std::chrono::duration<double>(blockSize / sfz::config::defaultSampleRate);
+    auto deadline = std::chrono::steady_clock::now();
+    const auto initialUnderruns = synth->getNumStreamUnderruns();
+    for (auto _ : state) {
+        synth->renderBlock(buffer);
+        benchmark::DoNotOptimize(buffer);
+        state.PauseTiming();
+        deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(blockDuration);
+        std::this_thread::sleep_until(deadline);
+        state.ResumeTiming();
+    }
+    state.counters["Voices"] = synth->getNumActiveVoices();
+    state.counters["Underruns"] = benchmark::Counter(synth->getNumStreamUnderruns() - initialUnderruns,
+        benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_REGISTER_F(RenderFixture, ActiveVoices)->RangeMultiplier(2)->Range(1, sfz::config::numVoices);
+BENCHMARK_REGISTER_F(RenderFixture, Threads)->Apply(threadArguments)->UseRealTime();
+BENCHMARK_REGISTER_F(RenderFixture, NoteStorm)->Arg(sfz::config::numVoices);
+BENCHMARK_REGISTER_F(LoopFixture, ShortLoops)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK_REGISTER_F(QualityFixture, SampleQuality)->Apply(qualityArguments);
+BENCHMARK_REGISTER_F(GeneratorFixture, Generators)->ArgsProduct({ { 0, 1, 2 }, { 8, 32 } });
+// 20 seconds of sample are enough for 400 blocks
+BENCHMARK_REGISTER_F(StreamFixture, Streaming)->ArgsProduct({ { 0, 64, 16 }, { 0, 1 } })->Iterations(400);
+BENCHMARK_MAIN();
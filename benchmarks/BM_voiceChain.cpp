@@ -0,0 +1,190 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Compares the former voice processing chain, which applies each stage as a
+// separate pass over the buffers, with the fused mono/stereo mix kernels.
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../sfizz/SIMDHelpers.h"
+#include "../sfizz/Config.h"
+#include "absl/types/span.h"
+
+class VoiceChain : public benchmark::Fixture {
+public:
+  void SetUp(const ::benchmark::State& state) {
+    std::random_device rd { };
+    std::mt19937 gen { rd() };
+    std::uniform_real_distribution<float> dist { 0.001, 1 };
+    const auto size = static_cast<size_t>(state.range(0));
+    for (auto* vec : { &amplitude, &eg, &volume, &pan, &width, &position, &inputLeft, &inputRight }) {
+        vec->resize(size);
+        std::generate(vec->begin(), vec->end(), [&]() { return dist(gen); });
+    }
+    for (auto* vec : { &left, &right, &outputLeft, &outputRight, &temp1, &temp2, &temp3, &temp4, &temp5 })
+        vec->resize(size);
+  }
+
+  void TearDown(const ::benchmark::State& state [[maybe_unused]]) {
+
+  }
+
+  // Stands in for the envelope getBlock() calls
+  void envelope(const std::vector<float>& source, std::vector<float>& output) {
+    sfz::copy<float>(source, absl::MakeSpan(output));
+  }
+
+  void panCoefficients(const std::vector<float>& source, std::vector<float>& cosOutput, std::vector<float>& sinOutput) {
+    envelope(source, sinOutput);
+    sfz::panLaw<float>(sinOutput, absl::MakeSpan(cosOutput), absl::MakeSpan(sinOutput));
+  }
+
+  void gainEnvelope(std::vector<float>& gain, std::vector<float>& scratch) {
+    envelope(amplitude, gain);
+    envelope(eg, scratch);
+    sfz::applyGain<float>(scratch, absl::MakeSpan(gain));
+    envelope(volume, scratch);
+    sfz::applyGain<float>(scratch, absl::MakeSpan(gain));
+  }
+
+  std::vector<float> amplitude;
+  std::vector<float> eg;
+  std::vector<float> volume;
+  std::vector<float> pan;
+  std::vector<float> width;
+  std::vector<float> position;
+  std::vector<float> inputLeft;
+  std::vector<float> inputRight;
+  std::vector<float> left;
+  std::vector<float> right;
+  std::vector<float> outputLeft;
+  std::vector<float> outputRight;
+  std::vector<float> temp1;
+  std::vector<float> temp2;
+  std::vector<float> temp3;
+  std::vector<float> temp4;
+  std::vector<float> temp5;
+};
+
+BENCHMARK_DEFINE_F(VoiceChain, MonoChain)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        auto span1 = absl::MakeSpan(temp1);
+        auto span2 = absl::MakeSpan(temp2);
+        envelope(amplitude, temp1);
+        sfz::applyGain<float>(span1, absl::MakeSpan(left));
+        envelope(eg, temp1);
+        sfz::applyGain<float>(span1, absl::MakeSpan(left));
+        envelope(volume, temp1);
+        sfz::applyGain<float>(span1, absl::MakeSpan(left));
+        benchmark::DoNotOptimize(sfz::meanSquared<float>(left));
+        envelope(pan, temp1);
+        sfz::fill<float>(span2, 1.0f);
+        sfz::add<float>(span1, span2);
+        sfz::applyGain<float>(piFour<float>, span2);
+        sfz::cos<float>(span2, span1);
+        sfz::sin<float>(span2, span2);
+        sfz::multiplyAdd<float>(span1, left, absl::MakeSpan(outputLeft));
+        sfz::multiplyAdd<float>(span2, left, absl::MakeSpan(outputRight));
+    }
+}
+
+BENCHMARK_DEFINE_F(VoiceChain, MonoFused)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        gainEnvelope(temp1, temp5);
+        panCoefficients(pan, temp2, temp3);
+        benchmark::DoNotOptimize(sfz::monoMix<float>(temp1, temp2, temp3, left, absl::MakeSpan(outputLeft), absl::MakeSpan(outputRight)));
+    }
+}
+
+BENCHMARK_DEFINE_F(VoiceChain, StereoChain)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
+        auto span1 = absl::MakeSpan(temp1);
+        auto span2 = absl::MakeSpan(temp2);
+        auto leftBuffer = absl::MakeSpan(left);
+        auto rightBuffer = absl::MakeSpan(right);
+        for (auto* source : { &amplitude, &eg, &volume }) {
+            envelope(*source, temp1);
+            sfz::applyGain<float>(span1, leftBuffer);
+            sfz::applyGain<float>(span1, rightBuffer);
+        }
+        benchmark::DoNotOptimize(sfz::meanSquared<float>(left) + sfz::meanSquared<float>(right));
+
+        sfz::copy<float>(rightBuffer, span1);
+        sfz::add<float>(leftBuffer, rightBuffer);
+        sfz::subtract<float>(span1, leftBuffer);
+        sfz::applyGain<float>(sqrtTwoInv<float>, leftBuffer);
+        sfz::applyGain<float>(sqrtTwoInv<float>, rightBuffer);
+
+        envelope(width, temp1);
+        sfz::fill<float>(span2, 1.0f);
+        sfz::add<float>(span1, span2);
+        sfz::applyGain<float>(piFour<float>, span2);
+        sfz::cos<float>(span2, span1);
+        sfz::sin<float>(span2, span2);
+        sfz::applyGain<float>(span1, leftBuffer);
+        sfz::applyGain<float>(span2, rightBuffer);
+
+        envelope(position, temp1);
+        sfz::fill<float>(span2, 1.0f);
+        sfz::add<float>(span1, span2);
+        sfz::applyGain<float>(piFour<float>, span2);
+        sfz::cos<float>(span2, span1);
+        sfz::sin<float>(span2, span2);
+
+        sfz::applyGain<float>(sqrtTwoInv<float>, span1);
+        sfz::applyGain<float>(sqrtTwoInv<float>, span2);
+        sfz::applyGain<float>(sqrtTwoInv<float>, rightBuffer);
+        sfz::add<float>(rightBuffer, absl::MakeSpan(outputLeft));
+        sfz::add<float>(rightBuffer, absl::MakeSpan(outputRight));
+        sfz::multiplyAdd<float>(span1, leftBuffer, absl::MakeSpan(outputLeft));
+        sfz::multiplyAdd<float>(span2, leftBuffer, absl::MakeSpan(outputRight));
+    }
+}
+
+BENCHMARK_DEFINE_F(VoiceChain, StereoFused)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
+        gainEnvelope(temp1, temp5);
+        panCoefficients(width, temp2, temp3);
+        panCoefficients(position, temp4, temp5);
+        benchmark::DoNotOptimize(sfz::stereoMix<float>(temp1, temp2, temp3, temp4, temp5,
+            left, right, absl::MakeSpan(outputLeft), absl::MakeSpan(outputRight)));
+    }
+}
+
+BENCHMARK_REGISTER_F(VoiceChain, MonoChain)->RangeMultiplier(4)->Range(1 << 6, 1 << 12);
+BENCHMARK_REGISTER_F(VoiceChain, MonoFused)->RangeMultiplier(4)->Range(1 << 6, 1 << 12);
+BENCHMARK_REGISTER_F(VoiceChain, StereoChain)->RangeMultiplier(4)->Range(1 << 6, 1 << 12);
+BENCHMARK_REGISTER_F(VoiceChain, StereoFused)->RangeMultiplier(4)->Range(1 << 6, 1 << 12);
+BENCHMARK_MAIN();
@@ -211,6 +211,47 @@ void ADSREnvelope<Type>::getBlock(absl::Span<Type> output) noexcept
         }
     }
 }
+
+template <class Type>
+absl::optional<Type> ADSREnvelope<Type>::getBlockOrConstant(absl::Span<Type> output) noexcept
+{
+    const auto size = static_cast<int>(output.size());
+    const bool releasing = shouldRelease && releaseDelay <= size;
+
+    switch (currentState) {
+    case State::Delay:
+        if (releasing || delay < size)
+            break;
+        delay -= size;
+        if (shouldRelease)
+            releaseDelay -= size;
+        return currentValue;
+    case State::Hold:
+        if (releasing || hold < size)
+            break;
+        hold -= size;
+        if (shouldRelease)
+            releaseDelay -= size;
+        return currentValue;
+    case State::Sustain:
+        if (releasing)
+            break;
+        if (shouldRelease)
+            releaseDelay -= size;
+        return currentValue;
+    case State::Done:
+        // A pending release has no effect once the envelope is done
+        if (shouldRelease && !releasing)
+            releaseDelay -= size;
+        return Type { 0.0 };
+    default:
+        break;
+    }
+
+    getBlock(output);
+    return absl::nullopt;
+}
+
 template <class Type>
 bool ADSREnvelope<Type>::isSmoothing() noexcept
 {
@@ -23,6 +23,7 @@
 
 #pragma once
 #include "LeakDetector.h"
+#include <absl/types/optional.h>
 #include <absl/types/span.h>
 namespace sfz {
 
@@ -33,6 +34,15 @@ public:
     void reset(int attack, int release, Type sustain = 1.0, int delay = 0, int decay = 0, int hold = 0, Type start = 0.0, Type depth = 1) noexcept;
     Type getNextValue() noexcept;
     void getBlock(absl::Span<Type> output) noexcept;
+    /**
+     * @brief Same as getBlock(), but if the envelope is flat over the block
+     * (delay, hold, sustain or done) the output is left untouched and the
+     * constant value is returned instead.
+     *
+     * @return the value of the envelope if it is constant over the block,
+     *         or absl::nullopt if the output has been written to
+     */
+    absl::optional<Type> getBlockOrConstant(absl::Span<Type> output) noexcept;
     void startRelease(int releaseDelay) noexcept;
     bool isSmoothing() noexcept;
 
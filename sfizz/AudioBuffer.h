@@ -59,6 +59,8 @@ public:
         bool returnedOK = true;
         for (auto i = 0; i < numChannels; ++i)
             returnedOK &= buffers[i]->resize(newSize);
+        if (returnedOK)
+            numFrames = newSize;
         return returnedOK;
     }
 
@@ -22,6 +22,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
+#include <cstddef>
 
 namespace sfz {
 
@@ -29,8 +30,22 @@ namespace config {
     constexpr float defaultSampleRate { 48000 };
     constexpr int defaultSamplesPerBlock { 1024 };
     constexpr int preloadSize { 8192 * 4 };
+    // Streams are kept this many blocks ahead of their voice, read in chunks of streamChunkFrames
+    constexpr int streamingBlocks { 32 };
+    constexpr int streamChunkFrames { 4096 };
+    // Stream the uncompressed WAV files from a memory mapping
+    constexpr bool memoryMapping { true };
+    // Memory budget for the decoded files that are not streamed, in bytes
+    constexpr size_t fileCacheSize { 256 * 1024 * 1024 };
     constexpr int numChannels { 2 };
     constexpr int numVoices { 64 };
+    constexpr int eventQueueSize { 1024 };
+    constexpr int renderQuantum { 64 };
+    // Released voices quieter than the threshold (in dB) for this many quanta are
+    // freed, provided that the next frames of their source are quiet too
+    constexpr float silenceThreshold { -90.0f };
+    constexpr int silenceQuanta { 32 };
+    constexpr int silenceLookahead { 4096 };
     constexpr int sustainCC { 64 };
     constexpr int halfCCThreshold { 64 };
     constexpr int centPerSemitone { 100 };
@@ -39,8 +54,8 @@ namespace config {
     constexpr char defineCharacter { '$' };
     constexpr int oversamplingFactor { 2 };
     constexpr float A440 { 440.0 };
+    // In render quanta, so the stealing follows the power of the last 1024 frames
     constexpr unsigned powerHistoryLength { 16 };
-    constexpr float voiceStealingThreshold { 0.00001 };
 } // namespace config
 
 
@@ -53,13 +68,21 @@ namespace SIMDConfig {
     constexpr bool mathfuns { false };
     constexpr bool loopingSFZIndex { true };
     constexpr bool saturatingSFZIndex { true };
+    constexpr bool fixedPointIndex { true };
+    constexpr bool linearInterpolation { true };
+    constexpr bool wavetableBatch { true };
+    constexpr bool hermiteInterpolation { true };
+    constexpr bool sincInterpolation { true };
     constexpr bool linearRamp { false };
     constexpr bool multiplicativeRamp { true };
     constexpr bool add { false };
     constexpr bool subtract { false };
     constexpr bool multiplyAdd { false };
+    constexpr bool monoMix { true };
+    constexpr bool stereoMix { true };
     constexpr bool copy { false };
     constexpr bool pan { true };
+    constexpr bool panLaw { true };
     constexpr bool cumsum { true };
     constexpr bool diff { false };
     constexpr bool sfzInterpolationCast { true };
@@ -31,6 +31,7 @@ enum class SfzLoopMode { no_loop, one_shot, loop_continuous, loop_sustain };
 enum class SfzOffMode { fast, normal };
 enum class SfzVelocityOverride { current, previous };
 enum class SfzCrossfadeCurve { gain, power };
+enum class SfzGenerator { sine, triangle, saw, square, noise, silence };
 
 namespace sfz
 {
@@ -48,7 +49,11 @@ namespace Default
 	constexpr Range<uint32_t> sampleEndRange { 0, std::numeric_limits<uint32_t>::max() };
 	constexpr Range<uint32_t> sampleCountRange { 0, std::numeric_limits<uint32_t>::max() };
 	constexpr SfzLoopMode loopMode { SfzLoopMode::no_loop };
+	constexpr SfzGenerator generator { SfzGenerator::silence };
 	constexpr Range<uint32_t> loopRange { 0, std::numeric_limits<uint32_t>::max() };
+	// 0-1: linear, 2: Hermite, 3-5: 8-tap windowed sinc, 6-10: 16-tap windowed sinc
+	constexpr int sampleQuality { 1 };
+	constexpr Range<int> sampleQualityRange { 0, 10 };
 
     // Instrument setting: voice lifecycle
 	constexpr uint32_t group { 0 };
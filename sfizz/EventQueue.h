@@ -0,0 +1,118 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "Debug.h"
+#include "LeakDetector.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace sfz {
+/**
+ * @brief Bounded multiple producers, single consumer queue. Any thread can push
+ * without locking; only the audio thread pops. The cells carry a sequence number
+ * that tells producers and the consumer whose turn it is, so a full queue makes
+ * tryPush() fail instead of blocking.
+ *
+ * @tparam Type the stored type, which should be cheap to copy
+ */
+template <class Type>
+class EventQueue {
+public:
+    EventQueue() = delete;
+    /**
+     * @brief Construct a new queue
+     *
+     * @param capacity the minimum number of elements; rounded up to a power of 2
+     */
+    EventQueue(size_t capacity)
+    {
+        size_t size { 2 };
+        while (size < capacity)
+            size *= 2;
+
+        cells = std::make_unique<Cell[]>(size);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Push a value; can be called from any thread.
+     *
+     * @return false if the queue is full and the value was dropped
+     */
+    bool tryPush(const Type& value) noexcept
+    {
+        auto position = writePosition.load(std::memory_order_relaxed);
+        while (true) {
+            auto& cell = cells[position & mask];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+            if (difference == 0) {
+                // The cell is free; claim it unless another producer was faster
+                if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = writePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Pop the oldest value; must only be called from the consumer thread.
+     *
+     * @return false if the queue is empty
+     */
+    bool tryPop(Type& value) noexcept
+    {
+        auto& cell = cells[readPosition & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != readPosition + 1)
+            return false;
+
+        value = cell.value;
+        cell.sequence.store(readPosition + mask + 1, std::memory_order_release);
+        readPosition++;
+        return true;
+    }
+
+    size_t capacity() const noexcept { return mask + 1; }
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Type value;
+    };
+    std::unique_ptr<Cell[]> cells;
+    size_t mask { 0 };
+    // Keep the producers and the consumer positions on separate cache lines
+    alignas(64) std::atomic<size_t> writePosition { 0 };
+    alignas(64) size_t readPosition { 0 };
+    LEAK_DETECTOR(EventQueue);
+};
+}
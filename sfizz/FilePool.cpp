@@ -31,7 +31,6 @@
 #include <mutex>
 #include <sndfile.hh>
 #include <thread>
-#include <mutex>
 using namespace std::chrono_literals;
 
 template <class T>
@@ -48,9 +47,19 @@ std::unique_ptr<sfz::AudioBuffer<T>> readFromFile(SndfileHandle& sndFile, int nu
     return returnedBuffer;
 }
 
-absl::optional<sfz::FilePool::FileInformation> sfz::FilePool::getFileInformation(const std::string& filename, uint32_t offset) noexcept
+// Number of frames preloaded for a file of numFrames frames played from an offset
+static uint32_t preloadedFrames(uint32_t numFrames, uint32_t offset)
+{
+    // FIXME: Large offsets will require large preloading; is this OK in practice?
+    if (sfz::config::preloadSize == 0)
+        return numFrames;
+
+    return std::min(numFrames, offset + static_cast<uint32_t>(sfz::config::preloadSize));
+}
+
+absl::optional<sfz::FilePool::FileInformation> sfz::FilePool::readFileInformation(absl::string_view filename, uint32_t offset) const noexcept
 {
-    fs::path file { rootDirectory / filename };
+    fs::path file { rootDirectory / std::string(filename) };
     if (!fs::exists(file))
         return {};
 
@@ -71,100 +80,409 @@ absl::optional<sfz::FilePool::FileInformation> sfz::FilePool::getFileInformation
         returnedValue.loopEnd = instrumentInfo.loops[0].end;
     }
 
-    // FIXME: Large offsets will require large preloading; is this OK in practice?
-    const auto preloadedSize = [&]() {
-        if (config::preloadSize == 0)
-            return returnedValue.end;
-        else
-            return std::min(returnedValue.end, offset + static_cast<uint32_t>(config::preloadSize));
-    }();
-
-    if (preloadedData.contains(filename)) {
-        auto alreadyPreloaded = preloadedData[filename];
-        if (preloadedSize > alreadyPreloaded->getNumFrames()) {
-            // FIXME: Okay, ideally here you would have a double indirection so that we can update _all_ the preloaded
-            // files in previous regions to account for the new offset
-            //
-            // Before this next command, some old regions and the file pool hold a shared pointer to the same audio buffer.
-            // This audio buffer is OK for the old regions, but too small for the new one.
-            // By resetting the filepool data to a new, longer audiobuffer, we are creating 2 copies of the same audio data.
-            // The filepool and the new regions have the longer copy, and the older regions have the shorter copy.
-            // This is not entirely optimal, but is it better to write a double shared pointer ?
-            // std::shared_ptr<std::shared_ptr<sfz::AudioBuffer>>> is a bit ugly...
-            alreadyPreloaded.reset(readFromFile<float>(sndFile, preloadedSize).release());
+    returnedValue.preloadedData = readFromFile<float>(sndFile, preloadedFrames(returnedValue.end, offset));
+    return returnedValue;
+}
+
+bool sfz::FilePool::coversOffset(const FileInformation& information, uint32_t offset) noexcept
+{
+    return preloadedFrames(information.end, offset) <= information.preloadedData->getNumFrames();
+}
+
+absl::optional<sfz::FilePool::FileInformation> sfz::FilePool::getFileInformation(const std::string& filename, uint32_t offset) noexcept
+{
+    auto cached = fileInformation.find(filename);
+    if (cached != fileInformation.end() && coversOffset(cached->second, offset))
+        return cached->second;
+
+    // When the file was already preloaded, the older regions keep the shorter copy of the
+    // preloaded data while the file pool and the new regions share a longer copy. The Synth
+    // never ends up here: loadSfzFile() reads each sample once, with the largest offset
+    // its regions play it from, so all of them share a single copy.
+    auto returnedValue = readFileInformation(filename, offset);
+    if (returnedValue)
+        fileInformation[filename] = *returnedValue;
+    return returnedValue;
+}
+
+std::vector<absl::optional<sfz::FilePool::FileInformation>> sfz::FilePool::scanFiles(absl::Span<const std::pair<absl::string_view, uint32_t>> files, int numThreads)
+{
+    std::vector<absl::optional<FileInformation>> information(files.size());
+    // Each thread takes the next file to read; the table of known files is only
+    // read until the threads are joined
+    std::atomic<size_t> nextFile { 0 };
+    auto scan = [&]() {
+        for (auto index = nextFile++; index < files.size(); index = nextFile++) {
+            const auto& file = files[index];
+            auto cached = fileInformation.find(file.first);
+            if (cached != fileInformation.end() && coversOffset(cached->second, file.second))
+                information[index] = cached->second;
+            else
+                information[index] = readFileInformation(file.first, file.second);
         }
-        returnedValue.preloadedData = alreadyPreloaded;
-    } else {
-        returnedValue.preloadedData = readFromFile<float>(sndFile, preloadedSize);
-        preloadedData[filename] = returnedValue.preloadedData;
+    };
+
+    std::vector<std::thread> threads;
+    const auto numWorkers = std::min(static_cast<size_t>(std::max(numThreads, 1)), files.size());
+    for (size_t i = 1; i < numWorkers; ++i)
+        threads.emplace_back(scan);
+    scan();
+    for (auto& thread : threads)
+        thread.join();
+
+    for (size_t index = 0; index < files.size(); ++index) {
+        if (information[index])
+            fileInformation[files[index].first] = *information[index];
     }
+    return information;
+}
 
-    return returnedValue;
+// Keep as much room behind the read position of a stream as ahead of it
+static int streamCapacity(int lookahead)
+{
+    int capacity { 1 };
+    while (capacity < 2 * lookahead)
+        capacity *= 2;
+    return capacity;
+}
+
+sfz::FilePool::FilePool()
+{
+    streams.resize(config::numVoices);
+    for (auto& stream : streams) {
+        stream = std::make_unique<FileStream>();
+        stream->resize(streamCapacity(streamingLookahead));
+    }
+    startThreads();
+}
+
+sfz::FilePool::~FilePool()
+{
+    stopThreads();
+}
+
+void sfz::FilePool::startThreads()
+{
+    quitThread = false;
+    fileLoadingThread = std::thread(&FilePool::loadingThread, this);
+    garbageCollectionThread = std::thread(&FilePool::garbageThread, this);
+}
+
+void sfz::FilePool::stopThreads()
+{
+    quitThread = true;
+    if (fileLoadingThread.joinable())
+        fileLoadingThread.join();
+    if (garbageCollectionThread.joinable())
+        garbageCollectionThread.join();
 }
 
 void sfz::FilePool::enqueueLoading(Voice* voice, const std::string* sample, int numFrames, unsigned ticket) noexcept
 {
-    if (!loadingQueue.try_enqueue({ voice, sample, numFrames, ticket })) {
+    if (!loadingQueue.try_enqueue({ voice, sample, numFrames, ticket, nullptr, 0 })) {
         DBG("Problem enqueuing a file read for file " << sample);
     }
 }
 
+void sfz::FilePool::enqueueStreaming(FileStream* stream, const Region& region, int startFrame, unsigned ticket) noexcept
+{
+    ASSERT(ticket != 0);
+    ASSERT(region.preloadedData != nullptr);
+    const auto preloadedFrames = static_cast<int>(region.preloadedData->getNumFrames());
+    const auto streamStart = std::max(std::max(preloadedFrames, startFrame) - FileStream::guardFrames, 0);
+    stream->request(ticket, streamStart);
+    if (!loadingQueue.try_enqueue({ nullptr, &region.sample, static_cast<int>(region.trueSampleEnd()), ticket, stream, streamStart })) {
+        DBG("Problem enqueuing a stream for file " << region.sample);
+    }
+}
+
+void sfz::FilePool::setNumVoices(int numVoices)
+{
+    // The background threads must not touch the queue, the streams or the voices while they change
+    stopThreads();
+    loadingQueue = moodycamel::BlockingReaderWriterQueue<FileLoadingInformation>(numVoices);
+    // The voices streaming from the current streams are dropped along with their requests
+    for (auto& stream : streams) {
+        stream->request(0, 0);
+        stream->close();
+    }
+    streams.resize(numVoices);
+    for (auto& stream : streams) {
+        if (stream == nullptr) {
+            stream = std::make_unique<FileStream>();
+            stream->resize(streamCapacity(streamingLookahead));
+        }
+    }
+    startThreads();
+}
+
+sfz::FileStream* sfz::FilePool::getStream(int index) noexcept
+{
+    ASSERT(index >= 0 && index < static_cast<int>(streams.size()));
+    return streams[index].get();
+}
+
+bool sfz::FilePool::setStreamingLookahead(int numFrames)
+{
+    numFrames = std::max(numFrames, 2 * config::streamChunkFrames);
+    const auto capacity = streamCapacity(numFrames);
+    // Larger streams still work with a shorter lookahead, so the streams only ever grow
+    const bool grow = std::any_of(streams.begin(), streams.end(),
+        [capacity](const std::unique_ptr<FileStream>& stream) { return stream->getCapacity() < capacity; });
+    if (!grow) {
+        streamingLookahead = numFrames;
+        return false;
+    }
+
+    // The lookahead only grows once the streams have room for it
+    stopThreads();
+    for (auto& stream : streams) {
+        if (stream->getCapacity() < capacity)
+            stream->resize(capacity);
+    }
+    streamingLookahead = numFrames;
+    startThreads();
+    return true;
+}
+
+int sfz::FilePool::getNumStreamUnderruns() const noexcept
+{
+    int underruns { 0 };
+    for (auto& stream : streams)
+        underruns += stream->getNumUnderruns();
+    return underruns;
+}
+
 void sfz::FilePool::loadingThread() noexcept
 {
+    constexpr auto pollPeriod { 2ms };
+    bool streamsPending { false };
     while (!quitThread) {
-        FileLoadingInformation fileToLoad {};
-        if (!loadingQueue.wait_dequeue_timed(fileToLoad, 200ms)) {
-            continue;
+        // Requests come first; the streams are topped up in between
+        FileLoadingInformation request {};
+        const bool dequeued = streamsPending
+            ? loadingQueue.try_dequeue(request)
+            : loadingQueue.wait_dequeue_timed(request, pollPeriod);
+
+        if (dequeued) {
+            if (request.stream != nullptr)
+                openStream(request);
+            else
+                loadFile(request);
         }
 
-        if (fileToLoad.voice == nullptr) {
-            DBG("Background thread error: voice is null.");
-            continue;
+        streamsPending = fillStreams();
+    }
+}
+
+void sfz::FilePool::loadFile(const FileLoadingInformation& fileToLoad) noexcept
+{
+    if (fileToLoad.voice == nullptr) {
+        DBG("Background thread error: voice is null.");
+        return;
+    }
+
+    if (fileToLoad.sample == nullptr) {
+        DBG("Background thread error: sample is null.");
+        return;
+    }
+
+    DBG("Background loading of: " << *fileToLoad.sample);
+    auto fileData = getCachedFile({ *fileToLoad.sample, fileToLoad.numFrames });
+    if (fileData == nullptr)
+        return;
+
+    fileToLoad.voice->setFileData(std::move(fileData), fileToLoad.ticket);
+    trimFileCache();
+}
+
+std::shared_ptr<sfz::AudioBuffer<float>> sfz::FilePool::getCachedFile(const CacheKey& key) noexcept
+{
+    {
+        std::lock_guard<std::mutex> guard { fileCacheMutex };
+        auto cached = fileCache.find(key);
+        if (cached != fileCache.end()) {
+            cached->second.lastUse = ++cacheUseCounter;
+            cacheHits++;
+            return cached->second.data;
         }
+    }
+
+    // Only the loading thread adds files, so the file can be decoded outside of the lock
+    fs::path file { rootDirectory / key.first };
+    if (!fs::exists(file)) {
+        DBG("Background thread: no file " << key.first << " exists.");
+        return {};
+    }
+
+    SndfileHandle sndFile(reinterpret_cast<const char*>(file.c_str()));
+    std::shared_ptr<AudioBuffer<float>> fileData = readFromFile<float>(sndFile, key.second);
+    std::lock_guard<std::mutex> guard { fileCacheMutex };
+    cacheMisses++;
+    cachedBytes += fileData->getNumFrames() * fileData->getNumChannels() * sizeof(float);
+    fileCache[key] = { fileData, ++cacheUseCounter };
+    return fileData;
+}
+
+void sfz::FilePool::trimFileCache() noexcept
+{
+    std::lock_guard<std::mutex> guard { fileCacheMutex };
+    while (cachedBytes > fileCacheSize) {
+        // Evict the least recently used file that no voice is playing
+        auto oldest = fileCache.end();
+        for (auto cached = fileCache.begin(); cached != fileCache.end(); ++cached) {
+            if (cached->second.data.use_count() > 1)
+                continue;
+
+            if (oldest == fileCache.end() || cached->second.lastUse < oldest->second.lastUse)
+                oldest = cached;
+        }
+
+        if (oldest == fileCache.end())
+            break;
+
+        const auto& fileData = oldest->second.data;
+        cachedBytes -= fileData->getNumFrames() * fileData->getNumChannels() * sizeof(float);
+        fileCache.erase(oldest);
+        cacheEvictions++;
+    }
+}
 
-        if (fileToLoad.sample == nullptr) {
-            DBG("Background thread error: sample is null.");
+sfz::FilePool::CacheStatistics sfz::FilePool::getFileCacheStatistics() const noexcept
+{
+    return { cacheHits.load(), cacheMisses.load(), cacheEvictions.load(), cachedBytes.load() };
+}
+
+void sfz::FilePool::openStream(const FileLoadingInformation& streamToOpen) noexcept
+{
+    auto* stream = streamToOpen.stream;
+    stream->close();
+    // The voice may have moved on to another note already
+    if (stream->getRequestedTicket() != streamToOpen.ticket)
+        return;
+
+    fs::path file { rootDirectory / *streamToOpen.sample };
+    if (memoryMapping) {
+        auto mapping = getMappedFile(*streamToOpen.sample);
+        if (mapping != nullptr) {
+            mapping->willNeed(streamToOpen.startFrame, streamingLookahead);
+            stream->open(std::move(mapping), streamToOpen.ticket, streamToOpen.startFrame, streamToOpen.numFrames);
+            return;
+        }
+    }
+
+    SndfileHandle sndFile(reinterpret_cast<const char*>(file.c_str()));
+    if (sndFile.channels() != 1 && sndFile.channels() != 2) {
+        DBG("Background thread: cannot stream " << *streamToOpen.sample);
+        return;
+    }
+
+    sndFile.seek(streamToOpen.startFrame, SEEK_SET);
+    stream->open(std::move(sndFile), streamToOpen.ticket, streamToOpen.startFrame, streamToOpen.numFrames);
+}
+
+std::shared_ptr<const sfz::MappedWav> sfz::FilePool::getMappedFile(const std::string& sample) noexcept
+{
+    auto mapped = mappedFiles.find(sample);
+    if (mapped != mappedFiles.end())
+        return mapped->second;
+
+    // Files that cannot be mapped are remembered as well, and read through libsndfile
+    auto mapping = std::make_shared<MappedWav>();
+    if (!mapping->open(rootDirectory / sample))
+        mapping.reset();
+    mappedFiles[sample] = mapping;
+    return mapping;
+}
+
+bool sfz::FilePool::fillStreams() noexcept
+{
+    // Serve the stream with the fewest frames buffered ahead of its voice
+    FileStream* starved { nullptr };
+    int framesToWrite { 0 };
+    for (auto& stream : streams) {
+        if (!stream->isOpen())
+            continue;
+
+        if (!stream->isRequested()) {
+            stream->close();
             continue;
         }
 
-        DBG("Background loading of: " << *fileToLoad.sample);
-        fs::path file { rootDirectory / *fileToLoad.sample };
-        if (!fs::exists(file)) {
-            DBG("Background thread: no file " << *fileToLoad.sample << " exists.");
+        const auto numFrames = stream->getFramesToWrite(streamingLookahead);
+        if (numFrames == 0)
             continue;
+
+        if (starved == nullptr || stream->getBufferedFrames() < starved->getBufferedFrames()) {
+            starved = stream.get();
+            framesToWrite = numFrames;
         }
+    }
 
-        SndfileHandle sndFile(reinterpret_cast<const char*>(file.c_str()));
-        
-        std::lock_guard<std::mutex> guard { fileHandleMutex };
-        fileHandles.emplace_back(readFromFile<float>(sndFile, fileToLoad.numFrames));
-        fileToLoad.voice->setFileData(fileHandles.back(), fileToLoad.ticket);
+    if (starved == nullptr)
+        return false;
+
+    framesToWrite = std::min(framesToWrite, config::streamChunkFrames);
+    const auto numChannels = starved->getNumChannels();
+    const auto nextFrame = starved->getNextFileFrame();
+    const auto framesToRead = std::min(framesToWrite, starved->getEndFrame() - nextFrame);
+    int framesRead { 0 };
+    if (framesToRead > 0 && starved->getMapping() != nullptr) {
+        const auto* mapping = starved->getMapping();
+        const auto frames = static_cast<size_t>(framesToRead);
+        if (numChannels == 1)
+            framesRead = mapping->read(nextFrame, AudioSpan<float>({ chunk.channelWriter(0) }, frames));
+        else
+            framesRead = mapping->read(nextFrame, AudioSpan<float>({ chunk.channelWriter(0), chunk.channelWriter(1) }, frames));
+        // Page in what comes next while the voice plays the frames written so far
+        mapping->willNeed(nextFrame + framesRead, streamingLookahead);
+    } else if (framesToRead > 0) {
+        auto& file = starved->getFile();
+        if (numChannels == 1) {
+            framesRead = static_cast<int>(file.readf(chunk.channelWriter(0), framesToRead));
+        } else {
+            interleavedChunk.resize(2 * config::streamChunkFrames);
+            framesRead = static_cast<int>(file.readf(interleavedChunk.data(), framesToRead));
+            readInterleaved<float>(absl::MakeConstSpan(interleavedChunk.data(), 2 * framesRead),
+                chunk.getSpan(0).first(framesRead), chunk.getSpan(1).first(framesRead));
+        }
     }
+    starved->write(AudioSpan<const float>(chunk).first(framesRead), framesToWrite);
+
+    const auto readRate = streamingReadRate.load();
+    if (readRate > 0.0) {
+        const auto bytes = static_cast<double>(framesRead * numChannels * sizeof(float));
+        std::this_thread::sleep_for(std::chrono::duration<double>(bytes / readRate));
+    }
+    return true;
 }
 
 void sfz::FilePool::garbageThread() noexcept
 {
+    // The budget may have shrunk, or files may have been released since they were loaded
     while (!quitThread) {
-        fileHandleMutex.lock();
-        for (auto handle = fileHandles.begin(); handle < fileHandles.end();) {
-            if (handle->use_count() == 1) {
-                handle->reset();
-                std::iter_swap(handle, fileHandles.end() - 1);
-                fileHandles.pop_back();
-            } else {
-                handle++;
-            }
-        }
-        fileHandleMutex.unlock();
+        trimFileCache();
         std::this_thread::sleep_for(200ms);
     }
 }
 
 void sfz::FilePool::clear()
 {
-    preloadedData.clear();
-    fileHandles.clear();
+    // The pending requests point to the regions being cleared
+    stopThreads();
     while (loadingQueue.pop()) {
         // Pop the queue
     }
+    for (auto& stream : streams) {
+        stream->request(0, 0);
+        stream->close();
+    }
+    fileInformation.clear();
+    mappedFiles.clear();
+    fileCache.clear();
+    cachedBytes = 0;
+    cacheHits = 0;
+    cacheMisses = 0;
+    cacheEvictions = 0;
+    startThreads();
 }
@@ -27,27 +27,29 @@
 #include "LeakDetector.h"
 #include "AudioBuffer.h"
 #include "Voice.h"
+#include "FileStream.h"
+#include "MappedWav.h"
+#include "Region.h"
 #include "ghc/fs_std.hpp"
 #include "readerwriterqueue.h"
 #include <absl/container/flat_hash_map.h>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <absl/types/optional.h>
+#include <absl/types/span.h>
 #include <string_view>
+#include <utility>
 #include <thread>
+#include <vector>
 
 namespace sfz {
 class FilePool {
 public:
-    FilePool() { }
-
-    ~FilePool()
-    {
-        quitThread = true;
-        fileLoadingThread.join();
-        garbageCollectionThread.join();
-    }
+    FilePool();
+    ~FilePool();
     void setRootDirectory(const fs::path& directory) noexcept { rootDirectory = directory; }
-    size_t getNumPreloadedSamples() const noexcept { return preloadedData.size(); }
+    size_t getNumPreloadedSamples() const noexcept { return fileInformation.size(); }
 
     struct FileInformation {
         uint32_t end { Default::sampleEndRange.getEnd() };
@@ -56,27 +58,139 @@ public:
         double sampleRate { config::defaultSampleRate };
         std::shared_ptr<AudioBuffer<float>> preloadedData;
     };
+    /**
+     * @brief Information and preloaded data of a file. Each file is read once and
+     * kept until clear(); only an offset past the preloaded data reads it again.
+     */
     absl::optional<FileInformation> getFileInformation(const std::string& filename, uint32_t offset) noexcept;
+    /**
+     * @brief Open, read the information and preload a set of files, spread over
+     * several threads. The files already known are not read again.
+     *
+     * @param files each sample once, with the largest offset it is played from
+     * @param numThreads the number of threads opening the files
+     * @return the information of each file in order, or nothing for the files that cannot be read
+     */
+    std::vector<absl::optional<FileInformation>> scanFiles(absl::Span<const std::pair<absl::string_view, uint32_t>> files, int numThreads);
     void enqueueLoading(Voice* voice, const std::string* sample, int numFrames, unsigned ticket) noexcept;
+    /**
+     * @brief Stream the rest of a region after its preloaded data. The stream
+     * starts a few frames before the end of the preloaded data, so that the
+     * interpolators can read across the boundary.
+     *
+     * @param stream the stream of the voice playing the region
+     * @param region
+     * @param startFrame the frame the voice starts playing from
+     * @param ticket a new ticket for the stream, not 0
+     */
+    void enqueueStreaming(FileStream* stream, const Region& region, int startFrame, unsigned ticket) noexcept;
+    /**
+     * @brief Resize the loading queue to hold one request per voice, and
+     * allocate a stream per voice. Pending requests are dropped, so this must
+     * be called before the voices are reallocated and never from the audio thread.
+     */
+    void setNumVoices(int numVoices);
+    FileStream* getStream(int index) noexcept;
+    /**
+     * @brief Set how many frames the loading thread keeps buffered ahead of the
+     * read position of each stream. The streams too small for the lookahead are
+     * reallocated, which stops them; the others keep playing. Must not be called
+     * from the audio thread.
+     *
+     * @return true if the streams were reallocated
+     */
+    bool setStreamingLookahead(int numFrames);
+    int getStreamingLookahead() const noexcept { return streamingLookahead; }
+    /**
+     * @brief Limit the rate at which the loading thread reads the streams, in
+     * bytes of decoded audio per second, to leave some bandwidth to the rest of
+     * the system or to emulate slow storage. 0 removes the limit.
+     */
+    void setStreamingReadRate(double bytesPerSecond) noexcept { streamingReadRate = bytesPerSecond; }
+    /**
+     * @brief Stream the uncompressed WAV files from a memory mapping rather than
+     * through libsndfile, when the platform supports it.
+     */
+    void setMemoryMapping(bool enabled) noexcept { memoryMapping = enabled; }
+    bool getMemoryMapping() const noexcept { return memoryMapping; }
+    /**
+     * @brief Total number of render quanta where a voice caught up with its stream.
+     */
+    int getNumStreamUnderruns() const noexcept;
+    /**
+     * @brief Set the memory budget of the decoded file cache, in bytes. Files
+     * that no voice plays anymore are evicted, least recently used first, when
+     * the cache grows past the budget.
+     */
+    void setFileCacheSize(size_t numBytes) noexcept { fileCacheSize = numBytes; }
+    size_t getFileCacheSize() const noexcept { return fileCacheSize; }
+    struct CacheStatistics {
+        int hits;
+        int misses;
+        int evictions;
+        size_t numBytes;
+    };
+    CacheStatistics getFileCacheStatistics() const noexcept;
     void clear();
 private:
     fs::path rootDirectory;
+    absl::optional<FileInformation> readFileInformation(absl::string_view filename, uint32_t offset) const noexcept;
+    // Whether the preloaded data is long enough to play the file from an offset
+    static bool coversOffset(const FileInformation& information, uint32_t offset) noexcept;
     struct FileLoadingInformation {
         Voice* voice;
         const std::string* sample;
         int numFrames;
         unsigned ticket;
+        // Streaming requests have a stream and no voice
+        FileStream* stream;
+        int startFrame;
     };
 
     moodycamel::BlockingReaderWriterQueue<FileLoadingInformation> loadingQueue { config::numVoices };
     void loadingThread() noexcept;
     void garbageThread() noexcept;
-    bool quitThread { false };
-    std::mutex fileHandleMutex;
-    std::vector<std::shared_ptr<AudioBuffer<float>>> fileHandles;
-    absl::flat_hash_map<absl::string_view, std::shared_ptr<AudioBuffer<float>>> preloadedData;
-    std::thread fileLoadingThread { &FilePool::loadingThread, this };
-    std::thread garbageCollectionThread { &FilePool::garbageThread, this };
+    void startThreads();
+    void stopThreads();
+    void loadFile(const FileLoadingInformation& fileToLoad) noexcept;
+    void openStream(const FileLoadingInformation& streamToOpen) noexcept;
+    bool fillStreams() noexcept;
+    std::shared_ptr<const MappedWav> getMappedFile(const std::string& sample) noexcept;
+    std::atomic<bool> quitThread { false };
+
+    // Decoded files shared between the voices, keyed by sample and number of frames.
+    // The cache holds a reference to each file so that the voices never free one
+    // from the audio thread; unreferenced files are evicted by trimFileCache().
+    using CacheKey = std::pair<std::string, int>;
+    struct CachedFile {
+        std::shared_ptr<AudioBuffer<float>> data;
+        uint64_t lastUse;
+    };
+    std::shared_ptr<AudioBuffer<float>> getCachedFile(const CacheKey& key) noexcept;
+    void trimFileCache() noexcept;
+    std::mutex fileCacheMutex;
+    absl::flat_hash_map<CacheKey, CachedFile> fileCache;
+    uint64_t cacheUseCounter { 0 };
+    std::atomic<size_t> fileCacheSize { config::fileCacheSize };
+    std::atomic<size_t> cachedBytes { 0 };
+    std::atomic<int> cacheHits { 0 };
+    std::atomic<int> cacheMisses { 0 };
+    std::atomic<int> cacheEvictions { 0 };
+    // Files read so far, by sample name
+    absl::flat_hash_map<std::string, FileInformation> fileInformation;
+
+    std::vector<std::unique_ptr<FileStream>> streams;
+    std::atomic<int> streamingLookahead { config::streamingBlocks * config::defaultSamplesPerBlock };
+    std::atomic<double> streamingReadRate { 0.0 };
+    std::atomic<bool> memoryMapping { config::memoryMapping };
+    // Only touched by the loading thread; files stay mapped until the pool is cleared
+    absl::flat_hash_map<std::string, std::shared_ptr<const MappedWav>> mappedFiles;
+    // Scratch memory of the loading thread
+    std::vector<float> interleavedChunk;
+    AudioBuffer<float> chunk { config::numChannels, config::streamChunkFrames };
+
+    std::thread fileLoadingThread;
+    std::thread garbageCollectionThread;
     LEAK_DETECTOR(FilePool);
 };
 }
@@ -0,0 +1,203 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "AudioBuffer.h"
+#include "AudioSpan.h"
+#include "Config.h"
+#include "LeakDetector.h"
+#include "MappedWav.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sndfile.hh>
+
+namespace sfz {
+/**
+ * @brief A ring buffer streaming the frames of a file to a voice.
+ *
+ * The frames are addressed by their position in the file. The loading thread
+ * writes the frames ahead of the read position published by the voice, and
+ * the voice reads the frames between its read position and the written end.
+ * A stream is restarted with a new ticket for each note; the voice only reads
+ * from it once the loading thread serves the ticket the voice asked for.
+ *
+ * The ring is surrounded by guard frames duplicating its other end, so that the
+ * interpolators can read a few frames around any index without wrapping.
+ */
+class FileStream {
+public:
+    static constexpr int guardFrames { 16 };
+    /**
+     * @brief Reallocate the ring; this drops the current stream.
+     *
+     * @param capacity a power of 2
+     */
+    void resize(int capacity)
+    {
+        ASSERT(capacity > guardFrames && (capacity & (capacity - 1)) == 0);
+        this->capacity = capacity;
+        ring = std::make_unique<AudioBuffer<float>>(config::numChannels, capacity + 2 * guardFrames);
+        close();
+        requestedTicket = 0;
+    }
+    int getCapacity() const noexcept { return capacity; }
+
+    // Audio thread side
+    /**
+     * @brief Ask the loading thread to stream from a frame under a new ticket;
+     * a ticket of 0 stops the stream.
+     */
+    void request(unsigned ticket, int startFrame) noexcept
+    {
+        readPosition.store(startFrame);
+        requestedTicket.store(ticket);
+    }
+    bool isReady(unsigned ticket) const noexcept { return activeTicket.load(std::memory_order_acquire) == ticket; }
+    /**
+     * @brief Publish the first frame the voice will read from now on. The loading
+     * thread may overwrite the frames before it, so this has to be called before
+     * getWrittenEnd() when reading.
+     */
+    void setReadPosition(int position) noexcept { readPosition.store(position); }
+    int getWrittenEnd() const noexcept { return writtenEnd.load(); }
+    /**
+     * @brief Index in the ring frames of a frame of the file.
+     */
+    int getRingIndex(int frame) const noexcept { return guardFrames + (frame & (capacity - 1)); }
+    AudioSpan<const float> getFrames() const noexcept
+    {
+        const auto numFrames = static_cast<size_t>(capacity + 2 * guardFrames);
+        if (numChannels == 1)
+            return AudioSpan<const float>({ ring->channelReader(0) }, numFrames);
+        return AudioSpan<const float>({ ring->channelReader(0), ring->channelReader(1) }, numFrames);
+    }
+    void countUnderrun() noexcept { underruns.fetch_add(1, std::memory_order_relaxed); }
+    int getNumUnderruns() const noexcept { return underruns.load(std::memory_order_relaxed); }
+
+    // Loading thread side
+    /**
+     * @brief Start serving the requested ticket from an opened file.
+     *
+     * @param startFrame the first frame written in the ring
+     * @param endFrame the end of the streamed part of the file; the ring is padded
+     * with the last frame after it
+     */
+    void open(SndfileHandle&& handle, unsigned ticket, int startFrame, int endFrame) noexcept
+    {
+        file = std::move(handle);
+        numChannels = file.channels();
+        start(ticket, startFrame, endFrame);
+    }
+    /**
+     * @brief Start serving the requested ticket from a memory mapped file, shared
+     * with the other streams reading the same file.
+     */
+    void open(std::shared_ptr<const MappedWav> mappedFile, unsigned ticket, int startFrame, int endFrame) noexcept
+    {
+        mapping = std::move(mappedFile);
+        numChannels = mapping->getNumChannels();
+        start(ticket, startFrame, endFrame);
+    }
+    void close() noexcept
+    {
+        activeTicket.store(0, std::memory_order_release);
+        file = SndfileHandle();
+        mapping.reset();
+    }
+    bool isOpen() const noexcept { return activeTicket.load(std::memory_order_relaxed) != 0; }
+    bool isRequested() const noexcept { return requestedTicket.load() == activeTicket.load(std::memory_order_relaxed); }
+    unsigned getRequestedTicket() const noexcept { return requestedTicket.load(); }
+    int getEndFrame() const noexcept { return endFrame; }
+    /**
+     * @brief Number of frames to write to reach a lookahead past the read position,
+     * without overwriting frames the voice may still read.
+     */
+    int getFramesToWrite(int lookahead) const noexcept
+    {
+        const auto position = readPosition.load();
+        const auto target = std::min({ position + lookahead, position + capacity, endFrame + guardFrames });
+        return std::max(target - writtenEnd.load(std::memory_order_relaxed), 0);
+    }
+    int getBufferedFrames() const noexcept { return writtenEnd.load(std::memory_order_relaxed) - readPosition.load(); }
+    int getNextFileFrame() const noexcept { return std::min(writtenEnd.load(std::memory_order_relaxed), endFrame); }
+    SndfileHandle& getFile() noexcept { return file; }
+    /**
+     * @brief The mapped file, if the stream was opened from one; otherwise read from getFile().
+     */
+    const MappedWav* getMapping() const noexcept { return mapping.get(); }
+    int getNumChannels() const noexcept { return numChannels; }
+    /**
+     * @brief Write frames at the written end and publish them. Frames past the end
+     * of the streamed part repeat its last frame.
+     *
+     * @param frames the frames read from the file, possibly fewer than numFrames
+     */
+    void write(AudioSpan<const float> frames, int numFrames) noexcept
+    {
+        const auto first = writtenEnd.load(std::memory_order_relaxed);
+        const auto numFileFrames = static_cast<int>(frames.getNumFrames());
+        for (int channel = 0; channel < numChannels; ++channel) {
+            auto* data = ring->channelWriter(channel);
+            const auto* input = frames.getSpan(channel).data();
+            for (int i = 0; i < numFrames; ++i) {
+                const auto frame = first + i;
+                float value { 0.0f };
+                if (i < numFileFrames)
+                    value = input[i];
+                else if (endFrame > 0)
+                    value = data[getRingIndex(endFrame - 1)];
+
+                const auto offset = frame & (capacity - 1);
+                data[guardFrames + offset] = value;
+                if (offset < guardFrames)
+                    data[guardFrames + capacity + offset] = value;
+                if (offset >= capacity - guardFrames)
+                    data[offset - (capacity - guardFrames)] = value;
+            }
+        }
+        writtenEnd.store(first + numFrames);
+    }
+
+private:
+    void start(unsigned ticket, int startFrame, int endFrame) noexcept
+    {
+        this->endFrame = endFrame;
+        writtenEnd.store(startFrame);
+        activeTicket.store(ticket, std::memory_order_release);
+    }
+    int capacity { 0 };
+    std::unique_ptr<AudioBuffer<float>> ring;
+    std::atomic<unsigned> requestedTicket { 0 };
+    std::atomic<unsigned> activeTicket { 0 };
+    std::atomic<int> readPosition { 0 };
+    std::atomic<int> writtenEnd { 0 };
+    std::atomic<int> underruns { 0 };
+    // Only touched by the loading thread, and read by the voice once the ticket is active
+    SndfileHandle file;
+    std::shared_ptr<const MappedWav> mapping;
+    int numChannels { 1 };
+    int endFrame { 0 };
+    LEAK_DETECTOR(FileStream);
+};
+}
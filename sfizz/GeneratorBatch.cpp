@@ -0,0 +1,70 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "GeneratorBatch.h"
+#include "SIMDHelpers.h"
+#include "Wavetables.h"
+
+void sfz::GeneratorBatch::setSamplesPerBlock(int samplesPerBlock)
+{
+    bus.resize(samplesPerBlock);
+}
+
+void sfz::GeneratorBatch::setNumVoices(int numVoices)
+{
+    tables.resize(numVoices);
+    positions.resize(numVoices);
+    steps.resize(numVoices);
+    gains.resize(numVoices);
+    powers.resize(numVoices);
+}
+
+void sfz::GeneratorBatch::renderVoices(absl::Span<Voice* const> voices, AudioSpan<float> output) noexcept
+{
+    const auto numVoices = voices.size();
+    const auto numFrames = output.getNumFrames();
+    ASSERT(numVoices <= tables.size());
+    ASSERT(numFrames <= bus.size());
+    if (numVoices == 0)
+        return;
+
+    for (size_t i = 0; i < numVoices; ++i) {
+        const auto block = voices[i]->beginWavetableBlock(static_cast<int>(numFrames));
+        tables[i] = block.table;
+        positions[i] = block.position;
+        steps[i] = block.step;
+        gains[i] = block.gain;
+        powers[i] = 0.0f;
+    }
+
+    auto busSpan = absl::MakeSpan(bus.data(), numFrames);
+    fill<float>(busSpan, 0.0f);
+    wavetableBatch<float>(absl::MakeConstSpan(tables.data(), numVoices), absl::MakeSpan(positions.data(), numVoices),
+        absl::MakeConstSpan(steps.data(), numVoices), absl::MakeConstSpan(gains.data(), numVoices),
+        absl::MakeSpan(powers.data(), numVoices), busSpan, WavetableBank::tableSize);
+    add<float>(busSpan, output.getSpan(0));
+    add<float>(busSpan, output.getSpan(1));
+
+    for (size_t i = 0; i < numVoices; ++i)
+        voices[i]->endWavetableBlock(positions[i], powers[i] / static_cast<float>(numFrames));
+}
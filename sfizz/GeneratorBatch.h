@@ -0,0 +1,66 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "AudioSpan.h"
+#include "Buffer.h"
+#include "Config.h"
+#include "LeakDetector.h"
+#include "Voice.h"
+#include <absl/types/span.h>
+#include <vector>
+
+namespace sfz {
+/**
+ * @brief Renders the periodic generator voices together in a single SIMD pass.
+ *
+ * The oscillator state of the voices is gathered in structure of arrays, and one
+ * kernel computes the voices side by side in the vector lanes and sums them in
+ * a mono bus. Since generators are identical on both channels the bus is then
+ * added to the left and right outputs.
+ *
+ * Only renderVoices() is meant to be called from the audio thread; the other
+ * methods allocate and must be called while the callback is disabled.
+ */
+class GeneratorBatch {
+public:
+    void setSamplesPerBlock(int samplesPerBlock);
+    /**
+     * @brief Set the maximum number of voices rendered at once.
+     */
+    void setNumVoices(int numVoices);
+    /**
+     * @brief Render the voices, which must all be batchable, and add them to the output.
+     */
+    void renderVoices(absl::Span<Voice* const> voices, AudioSpan<float> output) noexcept;
+
+private:
+    std::vector<const float*> tables;
+    std::vector<uint64_t> positions;
+    std::vector<uint64_t> steps;
+    std::vector<const float*> gains;
+    std::vector<float> powers;
+    Buffer<float> bus { static_cast<size_t>(config::defaultSamplesPerBlock) };
+    LEAK_DETECTOR(GeneratorBatch);
+};
+}
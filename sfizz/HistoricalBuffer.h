@@ -1,42 +1,61 @@
+#pragma once
+#include <algorithm>
 #include <vector>
 #include "SIMDHelpers.h"
 #include "absl/types/span.h"
 
 namespace sfz
 {
+/**
+ * @brief A ring of the last values pushed, with their average available in
+ * constant time. The sum is kept up to date on each push and recomputed from
+ * scratch each time the ring wraps, so that rounding errors cannot pile up.
+ */
 template<class ValueType>
 class HistoricalBuffer {
 public:
 	HistoricalBuffer() = delete;
 	HistoricalBuffer(size_t size)
-	: size(size)
 	{
 		resize(size);
 	}
 
-	void resize(int size)
+	void resize(size_t size)
 	{
 		buffer.resize(size);
+		reset();
+	}
+
+	void reset()
+	{
 		fill<ValueType>(absl::MakeSpan(buffer), 0.0);
 		index = 0;
+		sum = 0.0;
 	}
-	
+
 	void push(ValueType value)
 	{
-		if (size > 0) {
-			buffer[index] = value;
-			if (++index == size)
-				index = 0;
+		if (buffer.empty())
+			return;
+
+		sum += value - buffer[index];
+		buffer[index] = value;
+		if (++index == buffer.size()) {
+			index = 0;
+			sum = mean<ValueType>(buffer) * static_cast<ValueType>(buffer.size());
 		}
 	}
 
 	ValueType getAverage() const
 	{
-		return mean<ValueType>(buffer);
+		if (buffer.empty())
+			return 0.0;
+
+		return std::max(sum, static_cast<ValueType>(0.0)) / static_cast<ValueType>(buffer.size());
 	}
 private:
 	std::vector<ValueType> buffer;
-	size_t size { 0 };
 	size_t index { 0 };
+	ValueType sum { 0.0 };
 };
-}
\ No newline at end of file
+}
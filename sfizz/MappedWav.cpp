@@ -0,0 +1,209 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "MappedWav.h"
+#include "Debug.h"
+#include <algorithm>
+#include <cstring>
+#if (__linux__ || __unix__ || __APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SFIZZ_HAS_MMAP 1
+#endif
+
+namespace {
+template <class T>
+T readLittleEndian(const uint8_t* bytes) noexcept
+{
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+template <class Convert>
+void deinterleave(const uint8_t* frames, int bytesPerFrame, int bytesPerSample, sfz::AudioSpan<float> output, int numFrames, Convert&& convert) noexcept
+{
+    for (int channel = 0; channel < static_cast<int>(output.getNumChannels()); ++channel) {
+        auto* out = output.getChannel(channel);
+        const auto* in = frames + channel * bytesPerSample;
+        for (int i = 0; i < numFrames; ++i, in += bytesPerFrame)
+            out[i] = convert(in);
+    }
+}
+}
+
+sfz::MappedWav::~MappedWav()
+{
+    close();
+}
+
+bool sfz::MappedWav::open(const fs::path& path)
+{
+    close();
+#if SFIZZ_HAS_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (::fstat(fd, &fileStat) != 0 || fileStat.st_size < 12) {
+        ::close(fd);
+        return false;
+    }
+
+    mappingSize = static_cast<size_t>(fileStat.st_size);
+    mapping = ::mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file referenced
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        return false;
+    }
+
+    const auto* bytes = static_cast<const uint8_t*>(mapping);
+    if (std::memcmp(bytes, "RIFF", 4) != 0 || std::memcmp(bytes + 8, "WAVE", 4) != 0) {
+        close();
+        return false;
+    }
+
+    uint16_t formatTag { 0 };
+    uint16_t bitsPerSample { 0 };
+    uint16_t blockAlign { 0 };
+    size_t dataSize { 0 };
+    size_t position { 12 };
+    while (position + 8 <= mappingSize) {
+        const auto* chunk = bytes + position;
+        const auto chunkSize = static_cast<size_t>(readLittleEndian<uint32_t>(chunk + 4));
+        const auto bodySize = std::min(chunkSize, mappingSize - position - 8);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && bodySize >= 16) {
+            formatTag = readLittleEndian<uint16_t>(chunk + 8);
+            numChannels = readLittleEndian<uint16_t>(chunk + 10);
+            blockAlign = readLittleEndian<uint16_t>(chunk + 20);
+            bitsPerSample = readLittleEndian<uint16_t>(chunk + 22);
+            // WAVE_FORMAT_EXTENSIBLE stores the actual format at the start of its subformat GUID
+            if (formatTag == 0xfffe && bodySize >= 40)
+                formatTag = readLittleEndian<uint16_t>(chunk + 32);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            dataSize = bodySize;
+        }
+        position += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (formatTag == 1 && bitsPerSample == 16)
+        format = Format::pcm16;
+    else if (formatTag == 1 && bitsPerSample == 24)
+        format = Format::pcm24;
+    else if (formatTag == 1 && bitsPerSample == 32)
+        format = Format::pcm32;
+    else if (formatTag == 3 && bitsPerSample == 32)
+        format = Format::float32;
+    else
+        formatTag = 0;
+
+    bytesPerFrame = numChannels * bitsPerSample / 8;
+    if (formatTag == 0 || data == nullptr || numChannels < 1 || numChannels > 2 || blockAlign != bytesPerFrame) {
+        DBG("Cannot map " << path.string() << ", it will be read through libsndfile");
+        close();
+        return false;
+    }
+
+    numFrames = static_cast<int>(dataSize / bytesPerFrame);
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+void sfz::MappedWav::close() noexcept
+{
+#if SFIZZ_HAS_MMAP
+    if (mapping != nullptr)
+        ::munmap(mapping, mappingSize);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    data = nullptr;
+    numChannels = 0;
+    numFrames = 0;
+    bytesPerFrame = 0;
+}
+
+int sfz::MappedWav::read(int startFrame, AudioSpan<float> output) const noexcept
+{
+    ASSERT(static_cast<int>(output.getNumChannels()) == numChannels);
+    if (startFrame < 0 || startFrame >= numFrames)
+        return 0;
+
+    const auto framesToRead = std::min(static_cast<int>(output.getNumFrames()), numFrames - startFrame);
+    const auto* frames = data + static_cast<size_t>(startFrame) * bytesPerFrame;
+    const auto bytesPerSample = bytesPerFrame / numChannels;
+    // Same scaling as libsndfile for the integer formats
+    switch (format) {
+    case Format::pcm16:
+        deinterleave(frames, bytesPerFrame, bytesPerSample, output, framesToRead, [](const uint8_t* sample) {
+            return static_cast<float>(readLittleEndian<int16_t>(sample)) / 32768.0f;
+        });
+        break;
+    case Format::pcm24:
+        deinterleave(frames, bytesPerFrame, bytesPerSample, output, framesToRead, [](const uint8_t* sample) {
+            const auto value = static_cast<int32_t>(static_cast<uint32_t>(sample[0]) << 8 | static_cast<uint32_t>(sample[1]) << 16 | static_cast<uint32_t>(sample[2]) << 24);
+            return static_cast<float>(value >> 8) / 8388608.0f;
+        });
+        break;
+    case Format::pcm32:
+        deinterleave(frames, bytesPerFrame, bytesPerSample, output, framesToRead, [](const uint8_t* sample) {
+            return static_cast<float>(readLittleEndian<int32_t>(sample)) / 2147483648.0f;
+        });
+        break;
+    case Format::float32:
+        deinterleave(frames, bytesPerFrame, bytesPerSample, output, framesToRead, [](const uint8_t* sample) {
+            return readLittleEndian<float>(sample);
+        });
+        break;
+    }
+    return framesToRead;
+}
+
+void sfz::MappedWav::willNeed(int startFrame, int numFrames) const noexcept
+{
+#if SFIZZ_HAS_MMAP
+    startFrame = std::max(startFrame, 0);
+    numFrames = std::min(numFrames, this->numFrames - startFrame);
+    if (mapping == nullptr || numFrames <= 0)
+        return;
+
+    // madvise() wants a range starting on a page boundary
+    static const auto pageSize = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const auto begin = reinterpret_cast<uintptr_t>(data + static_cast<size_t>(startFrame) * bytesPerFrame);
+    const auto end = begin + static_cast<size_t>(numFrames) * bytesPerFrame;
+    const auto alignedBegin = begin & ~(pageSize - 1);
+    ::madvise(reinterpret_cast<void*>(alignedBegin), end - alignedBegin, MADV_WILLNEED);
+#else
+    (void)startFrame;
+    (void)numFrames;
+#endif
+}
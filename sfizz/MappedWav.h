@@ -0,0 +1,77 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "AudioSpan.h"
+#include "LeakDetector.h"
+#include "ghc/fs_std.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace sfz {
+/**
+ * @brief An uncompressed WAV file mapped in memory, read without going through
+ * libsndfile. The pages are shared with the page cache, and so with all the
+ * processes reading the same file.
+ *
+ * Supports mono and stereo 16, 24 and 32 bit PCM and 32 bit float data, in
+ * the little-endian layout of the host. Other files fail to open and are
+ * read through libsndfile instead.
+ */
+class MappedWav {
+public:
+    MappedWav() = default;
+    ~MappedWav();
+    MappedWav(const MappedWav&) = delete;
+    MappedWav& operator=(const MappedWav&) = delete;
+    /**
+     * @brief Map a file; false if the file cannot be mapped or has an unsupported format.
+     */
+    bool open(const fs::path& path);
+    bool isOpen() const noexcept { return mapping != nullptr; }
+    int getNumChannels() const noexcept { return numChannels; }
+    int getNumFrames() const noexcept { return numFrames; }
+    /**
+     * @brief Convert frames to float and deinterleave them in the output.
+     *
+     * @return the number of frames read, fewer than the output frames at the end of the file
+     */
+    int read(int startFrame, AudioSpan<float> output) const noexcept;
+    /**
+     * @brief Ask the kernel to start paging in the frames that will be read soon.
+     */
+    void willNeed(int startFrame, int numFrames) const noexcept;
+
+private:
+    void close() noexcept;
+    enum class Format { pcm16, pcm24, pcm32, float32 };
+    void* mapping { nullptr };
+    size_t mappingSize { 0 };
+    const uint8_t* data { nullptr };
+    Format format { Format::pcm16 };
+    int numChannels { 0 };
+    int numFrames { 0 };
+    int bytesPerFrame { 0 };
+    LEAK_DETECTOR(MappedWav);
+};
+}
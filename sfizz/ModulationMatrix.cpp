@@ -0,0 +1,89 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "ModulationMatrix.h"
+#include "MathHelpers.h"
+#include "SIMDHelpers.h"
+
+sfz::ModulationMatrix::ModulationMatrix(const MidiState& midiState)
+    : midiState(midiState)
+{
+}
+
+void sfz::ModulationMatrix::setBaseValue(ModulationTarget target, float value) noexcept
+{
+    baseValues[static_cast<int>(target)] = value;
+}
+
+void sfz::ModulationMatrix::start(absl::Span<const ModulationRouting> routings) noexcept
+{
+    this->routings = routings;
+    currentValues = computeTargets();
+    previousValues = currentValues;
+}
+
+void sfz::ModulationMatrix::evaluate() noexcept
+{
+    previousValues = currentValues;
+    if (!routings.empty())
+        currentValues = computeTargets();
+}
+
+sfz::ModulationMatrix::TargetValues sfz::ModulationMatrix::computeTargets() const noexcept
+{
+    TargetValues values { baseValues };
+    for (auto& routing : routings) {
+        float source { 0.0f };
+        switch (routing.source) {
+        case ModulationSource::cc:
+            source = normalizeCC(midiState.cc[routing.ccNumber]);
+            break;
+        }
+
+        auto& value = values[static_cast<int>(routing.target)];
+        if (routing.target == ModulationTarget::amplitude)
+            value *= source * routing.depth;
+        else
+            value += source * routing.depth;
+    }
+
+    auto& volume = values[static_cast<int>(ModulationTarget::volume)];
+    volume = db2mag(volume);
+    return values;
+}
+
+absl::optional<float> sfz::ModulationMatrix::getBlockOrConstant(ModulationTarget target, absl::Span<float> output) const noexcept
+{
+    const auto start = previousValues[static_cast<int>(target)];
+    const auto end = currentValues[static_cast<int>(target)];
+    if (start == end || output.empty())
+        return end;
+
+    linearRamp<float>(output, start, (end - start) / output.size());
+    return absl::nullopt;
+}
+
+float sfz::ModulationMatrix::getValue(ModulationTarget target) const noexcept
+{
+    return currentValues[static_cast<int>(target)];
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "LeakDetector.h"
+#include "MidiState.h"
+#include <absl/types/optional.h>
+#include <absl/types/span.h>
+#include <array>
+#include <cstdint>
+
+namespace sfz {
+
+// The velocity is applied once through the base values of a voice
+enum class ModulationSource {
+    cc
+};
+
+enum class ModulationTarget {
+    amplitude,
+    volume,
+    pan,
+    position,
+    width
+};
+constexpr int numModulationTargets { 5 };
+
+// The <curve> headers are not parsed yet, so the sources can only be used as is
+enum class ModulationCurve {
+    linear
+};
+
+/**
+ * @brief A routing from a modulation source to a voice parameter, compiled from
+ * the region opcodes when the file is loaded.
+ */
+struct ModulationRouting {
+    ModulationSource source;
+    uint8_t ccNumber; // only used by CC sources
+    ModulationTarget target;
+    float depth; // in units of the target, for a source going from 0 to 1
+    ModulationCurve curve { ModulationCurve::linear };
+};
+
+/**
+ * @brief Evaluates the modulation routings of a voice at control rate. Every
+ * call to evaluate() computes the value of each target, and the targets ramp
+ * linearly from their previous value over the next block. The cost of an
+ * evaluation only depends on the number of routings of the region. A source
+ * that changes during a block is read once at the next evaluation, so its change
+ * ramps in over the whole block instead of starting at its exact frame.
+ *
+ * The amplitude is a linear gain multiplied by each of its sources; the volume
+ * is summed in dB and converted to a linear gain; the pan, position and width
+ * are summed and kept between -1 and 1 by the users.
+ */
+class ModulationMatrix {
+public:
+    ModulationMatrix() = delete;
+    ModulationMatrix(const MidiState& midiState);
+    /**
+     * @brief Set the value of a target before any modulation; call before start().
+     */
+    void setBaseValue(ModulationTarget target, float value) noexcept;
+    /**
+     * @brief Start modulating a new voice. The routings must outlive the voice.
+     */
+    void start(absl::Span<const ModulationRouting> routings) noexcept;
+    /**
+     * @brief Evaluate the routings for the next block
+     */
+    void evaluate() noexcept;
+    /**
+     * @brief Ramp a target over the block from its previous value to the last
+     * evaluated one. If the target did not change the output is left untouched.
+     *
+     * @return the value of the target if it is constant over the block,
+     *         or absl::nullopt if the output has been written to
+     */
+    absl::optional<float> getBlockOrConstant(ModulationTarget target, absl::Span<float> output) const noexcept;
+    float getValue(ModulationTarget target) const noexcept;
+private:
+    using TargetValues = std::array<float, numModulationTargets>;
+    TargetValues computeTargets() const noexcept;
+    const MidiState& midiState;
+    absl::Span<const ModulationRouting> routings;
+    TargetValues baseValues {};
+    TargetValues previousValues {};
+    TargetValues currentValues {};
+    LEAK_DETECTOR(ModulationMatrix);
+};
+
+}
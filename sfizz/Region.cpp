@@ -43,6 +43,26 @@ bool sfz::Region::parseOpcode(const Opcode& opcode)
     // Sound source: sample playback
     case hash("sample"):
         sample = absl::StrReplaceAll(trim(opcode.value), { { "\\", "/" } });
+        switch (hash(sample)) {
+        case hash("*sine"):
+            generator = SfzGenerator::sine;
+            break;
+        case hash("*tri"):
+        case hash("*triangle"):
+            generator = SfzGenerator::triangle;
+            break;
+        case hash("*saw"):
+            generator = SfzGenerator::saw;
+            break;
+        case hash("*square"):
+            generator = SfzGenerator::square;
+            break;
+        case hash("*noise"):
+            generator = SfzGenerator::noise;
+            break;
+        default:
+            generator = Default::generator;
+        }
         break;
     case hash("delay"):
         setValueFromOpcode(opcode, delay, Default::delayRange);
@@ -91,6 +111,9 @@ bool sfz::Region::parseOpcode(const Opcode& opcode)
     case hash("loop_start"):
         setRangeStartFromOpcode(opcode, loopRange, Default::loopRange);
         break;
+    case hash("sample_quality"):
+        setValueFromOpcode(opcode, sampleQuality, Default::sampleQualityRange);
+        break;
 
     // Instrument settings: voice lifecycle
     case hash("group"):
@@ -254,10 +277,9 @@ bool sfz::Region::parseOpcode(const Opcode& opcode)
     case hash("volume"):
         setValueFromOpcode(opcode, volume, Default::volumeRange);
         break;
-    // case hash("volume_oncc"):
-    //     if (opcode.parameter)
-    //         setValueFromOpcode(opcode, volumeCCTriggers[*opcode.parameter], Default::volumeCCRange);
-    //     break;
+    case hash("volume_oncc"):
+        setCCPairFromOpcode(opcode, volumeCC, Default::volumeCCRange);
+        break;
     case hash("amplitude"):
         setValueFromOpcode(opcode, amplitude, Default::amplitudeRange);
         break;
@@ -644,6 +666,21 @@ float sfz::Region::getBaseGain() noexcept
     return normalizePercents(amplitude);
 }
 
+void sfz::Region::compileModulations()
+{
+    modulations.clear();
+    if (amplitudeCC)
+        modulations.push_back({ ModulationSource::cc, amplitudeCC->first, ModulationTarget::amplitude, normalizePercents(amplitudeCC->second) });
+    if (volumeCC)
+        modulations.push_back({ ModulationSource::cc, volumeCC->first, ModulationTarget::volume, volumeCC->second });
+    if (panCC)
+        modulations.push_back({ ModulationSource::cc, panCC->first, ModulationTarget::pan, normalizeNegativePercents(panCC->second) });
+    if (positionCC)
+        modulations.push_back({ ModulationSource::cc, positionCC->first, ModulationTarget::position, normalizeNegativePercents(positionCC->second) });
+    if (widthCC)
+        modulations.push_back({ ModulationSource::cc, widthCC->first, ModulationTarget::width, normalizeNegativePercents(widthCC->second) });
+}
+
 uint32_t sfz::Region::getOffset() noexcept
 {
     return offset + offsetDistribution(Random::randomGenerator);
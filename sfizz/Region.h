@@ -29,6 +29,7 @@
 #include "Opcode.h"
 #include "AudioBuffer.h"
 #include "MidiState.h"
+#include "ModulationMatrix.h"
 #include <bitset>
 #include <absl/types/optional.h>
 #include <random>
@@ -67,6 +68,11 @@ struct Region {
     uint32_t trueSampleEnd() const noexcept;
     bool canUsePreloadedData() const noexcept;
     bool parseOpcode(const Opcode& opcode);
+    /**
+     * @brief Build the modulation routings from the parsed opcodes. Call once
+     * every opcode of the region has been parsed.
+     */
+    void compileModulations();
 
     // Sound source: sample playback
     std::string sample {}; // Sample
@@ -78,6 +84,8 @@ struct Region {
     absl::optional<uint32_t> sampleCount {}; // count
     SfzLoopMode loopMode { Default::loopMode }; // loopmode
     Range<uint32_t> loopRange { Default::loopRange }; //loopstart and loopend
+    absl::optional<int> sampleQuality {}; // sample_quality
+    SfzGenerator generator { Default::generator }; // sample names starting with *
 
     // Instrument settings: voice lifecycle
     uint32_t group { Default::group }; // group
@@ -123,6 +131,7 @@ struct Region {
     absl::optional<CCValuePair> panCC; // pan_oncc
     absl::optional<CCValuePair> widthCC; // width_oncc
     absl::optional<CCValuePair> positionCC; // position_oncc
+    std::vector<ModulationRouting> modulations; // compiled from the _oncc opcodes
     uint8_t ampKeycenter { Default::ampKeycenter }; // amp_keycenter
     float ampKeytrack { Default::ampKeytrack }; // amp_keytrack
     float ampVeltrack { Default::ampVeltrack }; // amp_keytrack
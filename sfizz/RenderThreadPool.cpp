@@ -0,0 +1,269 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "RenderThreadPool.h"
+#include "ScopedFTZ.h"
+#include <chrono>
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+using namespace std::chrono_literals;
+
+namespace {
+constexpr int spinsBeforeYield { 1000 };
+constexpr int yieldsBeforeSleep { 1000 };
+
+inline uint64_t packRange(uint32_t front, uint32_t back) { return (static_cast<uint64_t>(front) << 32) | back; }
+inline uint32_t rangeFront(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+inline uint32_t rangeBack(uint64_t range) { return static_cast<uint32_t>(range); }
+}
+
+sfz::RenderThreadPool::RenderThreadPool()
+{
+    workers.push_back(std::make_unique<Worker>());
+    setDeterministic(false);
+}
+
+sfz::RenderThreadPool::~RenderThreadPool()
+{
+    stopThreads();
+}
+
+void sfz::RenderThreadPool::setNumThreads(int numThreads)
+{
+    numThreads = std::max(numThreads, 1);
+    if (numThreads == getNumThreads())
+        return;
+
+    stopThreads();
+    workers.clear();
+    for (int i = 0; i < numThreads; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+        workers.back()->bus.resize(samplesPerBlock);
+    }
+    startThreads();
+}
+
+int sfz::RenderThreadPool::getNumThreads() const noexcept
+{
+    return static_cast<int>(workers.size());
+}
+
+void sfz::RenderThreadPool::setDeterministic(bool deterministic)
+{
+    this->deterministic = deterministic;
+    voiceBuffers.clear();
+    if (deterministic) {
+        for (int i = 0; i < numVoices; ++i)
+            voiceBuffers.push_back(std::make_unique<AudioBuffer<float>>(config::numChannels, samplesPerBlock));
+    }
+}
+
+bool sfz::RenderThreadPool::isDeterministic() const noexcept
+{
+    return deterministic;
+}
+
+void sfz::RenderThreadPool::setSamplesPerBlock(int samplesPerBlock)
+{
+    this->samplesPerBlock = samplesPerBlock;
+    for (auto& worker : workers)
+        worker->bus.resize(samplesPerBlock);
+    for (auto& buffer : voiceBuffers)
+        buffer->resize(samplesPerBlock);
+}
+
+void sfz::RenderThreadPool::setNumVoices(int numVoices)
+{
+    this->numVoices = numVoices;
+    setDeterministic(deterministic);
+}
+
+void sfz::RenderThreadPool::startThreads()
+{
+    running = true;
+    const auto numCores = std::max(std::thread::hardware_concurrency(), 1u);
+    // The calling thread is worker 0 and belongs to the host
+    for (size_t i = 1; i < workers.size(); ++i) {
+        workers[i]->thread = std::thread(&RenderThreadPool::workerThread, this, static_cast<int>(i));
+#if defined(__linux__)
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(i % numCores, &cpuSet);
+        pthread_setaffinity_np(workers[i]->thread.native_handle(), sizeof(cpu_set_t), &cpuSet);
+#endif
+    }
+}
+
+void sfz::RenderThreadPool::stopThreads()
+{
+    running = false;
+    wakeUp.notify_all();
+    for (auto& worker : workers) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
+void sfz::RenderThreadPool::renderVoices(absl::Span<Voice* const> voices, AudioSpan<float> output) noexcept
+{
+    const auto numFrames = output.getNumFrames();
+    const auto numTasks = static_cast<int>(voices.size());
+    ASSERT(static_cast<int>(numFrames) <= samplesPerBlock);
+    ASSERT(!deterministic || numTasks <= static_cast<int>(voiceBuffers.size()));
+
+    if (workers.size() == 1 && !deterministic) {
+        for (auto* voice : voices)
+            voice->renderBlockAccumulate(output);
+        return;
+    }
+
+    if (numTasks == 0)
+        return;
+
+    jobVoices = voices;
+    jobFrames = static_cast<int>(numFrames);
+    remainingTasks.store(numTasks, std::memory_order_relaxed);
+
+    // Split the voices in contiguous ranges, one per thread
+    const auto numWorkers = static_cast<int>(workers.size());
+    for (int i = 0; i < numWorkers; ++i) {
+        const auto front = static_cast<uint32_t>(numTasks * i / numWorkers);
+        const auto back = static_cast<uint32_t>(numTasks * (i + 1) / numWorkers);
+        workers[i]->range.store(packRange(front, back), std::memory_order_release);
+    }
+
+    generation.fetch_add(1, std::memory_order_release);
+    if (sleepingWorkers.load(std::memory_order_acquire) > 0)
+        wakeUp.notify_all();
+
+    processTasks(0);
+
+    while (remainingTasks.load(std::memory_order_acquire) > 0 || busyWorkers.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+
+    if (deterministic) {
+        for (int i = 0; i < numTasks; ++i) {
+            auto voiceSpan = AudioSpan<float>(*voiceBuffers[i]).first(numFrames);
+            output.add(voiceSpan);
+        }
+        return;
+    }
+
+    for (auto& worker : workers) {
+        if (!worker->busUsed)
+            continue;
+
+        auto busSpan = AudioSpan<float>(worker->bus).first(numFrames);
+        output.add(busSpan);
+        worker->busUsed = false;
+    }
+}
+
+void sfz::RenderThreadPool::workerThread(int workerIndex) noexcept
+{
+    unsigned lastGeneration = generation.load(std::memory_order_acquire);
+    int idleCount { 0 };
+
+    while (running) {
+        if (generation.load(std::memory_order_acquire) == lastGeneration) {
+            if (++idleCount < spinsBeforeYield)
+                continue;
+
+            if (idleCount < spinsBeforeYield + yieldsBeforeSleep) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // The host may still render everything by itself if we oversleep
+            sleepingWorkers++;
+            std::unique_lock<std::mutex> lock { sleepMutex };
+            wakeUp.wait_for(lock, 1ms);
+            sleepingWorkers--;
+            continue;
+        }
+
+        idleCount = 0;
+        lastGeneration = generation.load(std::memory_order_acquire);
+        busyWorkers.fetch_add(1, std::memory_order_acq_rel);
+        processTasks(workerIndex);
+        busyWorkers.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void sfz::RenderThreadPool::processTasks(int workerIndex) noexcept
+{
+    ScopedFTZ ftz;
+    auto& worker = *workers[workerIndex];
+
+    for (auto task = popTask(worker); task >= 0; task = popTask(worker))
+        renderTask(worker, task);
+
+    const auto numWorkers = static_cast<int>(workers.size());
+    for (int i = 1; i < numWorkers; ++i) {
+        auto& victim = *workers[(workerIndex + i) % numWorkers];
+        for (auto task = stealTask(victim); task >= 0; task = stealTask(victim))
+            renderTask(worker, task);
+    }
+}
+
+int sfz::RenderThreadPool::popTask(Worker& worker) noexcept
+{
+    auto range = worker.range.load(std::memory_order_acquire);
+    while (rangeFront(range) < rangeBack(range)) {
+        const auto newRange = packRange(rangeFront(range) + 1, rangeBack(range));
+        if (worker.range.compare_exchange_weak(range, newRange, std::memory_order_acq_rel))
+            return static_cast<int>(rangeFront(range));
+    }
+    return -1;
+}
+
+int sfz::RenderThreadPool::stealTask(Worker& worker) noexcept
+{
+    auto range = worker.range.load(std::memory_order_acquire);
+    while (rangeFront(range) < rangeBack(range)) {
+        const auto newRange = packRange(rangeFront(range), rangeBack(range) - 1);
+        if (worker.range.compare_exchange_weak(range, newRange, std::memory_order_acq_rel))
+            return static_cast<int>(rangeBack(range) - 1);
+    }
+    return -1;
+}
+
+void sfz::RenderThreadPool::renderTask(Worker& worker, int taskIndex) noexcept
+{
+    auto* voice = jobVoices[taskIndex];
+
+    if (deterministic) {
+        auto voiceSpan = AudioSpan<float>(*voiceBuffers[taskIndex]).first(jobFrames);
+        voice->renderBlock(voiceSpan);
+    } else {
+        auto busSpan = AudioSpan<float>(worker.bus).first(jobFrames);
+        if (!worker.busUsed) {
+            busSpan.fill(0.0f);
+            worker.busUsed = true;
+        }
+        voice->renderBlockAccumulate(busSpan);
+    }
+
+    remainingTasks.fetch_sub(1, std::memory_order_acq_rel);
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "AudioBuffer.h"
+#include "AudioSpan.h"
+#include "Config.h"
+#include "LeakDetector.h"
+#include "Voice.h"
+#include <absl/types/span.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sfz {
+/**
+ * @brief Renders a set of voices on the calling thread and a set of worker threads.
+ *
+ * Each thread owns a contiguous range of the voices to render and steals from the
+ * end of the other ranges once its own is exhausted. In the default mode each thread
+ * sums its voices in a private bus, and the buses are added to the output at the end of
+ * the block. In deterministic mode every voice is rendered in its own buffer and the
+ * voices are summed in order, so that the output is bit-identical for any number of threads.
+ *
+ * Only renderVoices() is meant to be called from the audio thread; the other methods
+ * allocate and must be called while the callback is disabled.
+ */
+class RenderThreadPool {
+public:
+    RenderThreadPool();
+    ~RenderThreadPool();
+    /**
+     * @brief Set the total number of threads rendering voices, including the calling thread.
+     */
+    void setNumThreads(int numThreads);
+    int getNumThreads() const noexcept;
+    void setDeterministic(bool deterministic);
+    bool isDeterministic() const noexcept;
+    void setSamplesPerBlock(int samplesPerBlock);
+    /**
+     * @brief Set the maximum number of voices rendered at once, which sizes the
+     * per-voice buffers of the deterministic mode.
+     */
+    void setNumVoices(int numVoices);
+    void renderVoices(absl::Span<Voice* const> voices, AudioSpan<float> output) noexcept;
+
+private:
+    struct alignas(64) Worker {
+        // The front index in the high 32 bits and the back index in the low 32 bits
+        std::atomic<uint64_t> range { 0 };
+        AudioBuffer<float> bus { config::numChannels, config::defaultSamplesPerBlock };
+        bool busUsed { false };
+        std::thread thread;
+    };
+
+    void workerThread(int workerIndex) noexcept;
+    void processTasks(int workerIndex) noexcept;
+    int popTask(Worker& worker) noexcept;
+    int stealTask(Worker& worker) noexcept;
+    void renderTask(Worker& worker, int taskIndex) noexcept;
+    void startThreads();
+    void stopThreads();
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::unique_ptr<AudioBuffer<float>>> voiceBuffers;
+    int samplesPerBlock { config::defaultSamplesPerBlock };
+    int numVoices { config::numVoices };
+    bool deterministic { false };
+
+    // Current job; written by the calling thread before the ranges are published
+    absl::Span<Voice* const> jobVoices;
+    int jobFrames { 0 };
+    std::atomic<int> remainingTasks { 0 };
+    std::atomic<int> busyWorkers { 0 };
+    std::atomic<unsigned> generation { 0 };
+
+    std::atomic<bool> running { false };
+    std::atomic<int> sleepingWorkers { 0 };
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    LEAK_DETECTOR(RenderThreadPool);
+};
+}
@@ -83,6 +83,18 @@ void sfz::multiplyAdd<float, true>(absl::Span<const float> gain, absl::Span<cons
     multiplyAdd<float, false>(gain, input, output);
 }
 
+template <>
+float sfz::monoMix<float, true>(absl::Span<const float> gain, absl::Span<const float> panCos, absl::Span<const float> panSin, absl::Span<const float> input, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
+{
+    return monoMix<float, false>(gain, panCos, panSin, input, outputLeft, outputRight);
+}
+
+template <>
+float sfz::stereoMix<float, true>(absl::Span<const float> gain, absl::Span<const float> widthCos, absl::Span<const float> widthSin, absl::Span<const float> positionCos, absl::Span<const float> positionSin, absl::Span<const float> inputLeft, absl::Span<const float> inputRight, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
+{
+    return stereoMix<float, false>(gain, widthCos, widthSin, positionCos, positionSin, inputLeft, inputRight, outputLeft, outputRight);
+}
+
 template <>
 float sfz::loopingSFZIndex<float, true>(absl::Span<const float> jumps, absl::Span<float> leftCoeff, absl::Span<float> rightCoeff, absl::Span<int> indices, float floatIndex, float loopEnd, float loopStart) noexcept
 {
@@ -95,6 +107,23 @@ float sfz::saturatingSFZIndex<float, true>(absl::Span<const float> jumps, absl::
     return saturatingSFZIndex<float, false>(jumps, leftCoeff, rightCoeff, indices, floatIndex, loopEnd);
 }
 
+template <>
+uint64_t sfz::fixedPointIndex<float, true>(absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs, absl::Span<int> indices, uint64_t position, uint64_t step) noexcept
+{
+    return fixedPointIndex<float, false>(leftCoeffs, rightCoeffs, indices, position, step);
+}
+
+template <>
+void sfz::linearInterpolation<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> output) noexcept
+{
+    linearInterpolation<float, false>(source, indices, leftCoeffs, rightCoeffs, output);
+}
+
+template <>
+void sfz::linearInterpolation<float, true>(absl::Span<const float> sourceLeft, absl::Span<const float> sourceRight, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
+{
+    linearInterpolation<float, false>(sourceLeft, sourceRight, indices, leftCoeffs, rightCoeffs, outputLeft, outputRight);
+}
 
 template <>
 float sfz::linearRamp<float, true>(absl::Span<float> output, float start, float step) noexcept
@@ -145,6 +174,12 @@ void sfz::pan<float, true>(absl::Span<const float> panEnvelope, absl::Span<float
     pan<float, false>(panEnvelope, leftBuffer, rightBuffer);
 }
 
+template <>
+void sfz::panLaw<float, true>(absl::Span<const float> panEnvelope, absl::Span<float> cosOutput, absl::Span<float> sinOutput) noexcept
+{
+    panLaw<float, false>(panEnvelope, cosOutput, sinOutput);
+}
+
 template <>
 float sfz::mean<float, true>(absl::Span<const float> vector) noexcept
 {
@@ -169,8 +204,25 @@ void sfz::sfzInterpolationCast<float, true>(absl::Span<const float> floatJumps,
     sfzInterpolationCast<float, false>(floatJumps, jumps, leftCoeffs, rightCoeffs);
 }
 
+template <>
+void sfz::hermiteInterpolation<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept
+{
+    hermiteInterpolation<float, false>(source, indices, coeffs, output);
+}
+
+template <>
+void sfz::sincInterpolation<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output, int taps) noexcept
+{
+    sincInterpolation<float, false>(source, indices, coeffs, output, taps);
+}
+
 template <>
 void sfz::diff<float, true>(absl::Span<const float> input, absl::Span<float> output) noexcept
 {
     diff<float, false>(input, output);
-}
\ No newline at end of file
+}
+template <>
+void sfz::wavetableBatch<float, true>(absl::Span<const float* const> tables, absl::Span<uint64_t> positions, absl::Span<const uint64_t> steps, absl::Span<const float* const> gains, absl::Span<float> powers, absl::Span<float> output, int tableSize) noexcept
+{
+    wavetableBatch<float, false>(tables, positions, steps, gains, powers, output, tableSize);
+}
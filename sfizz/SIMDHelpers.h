@@ -27,7 +27,9 @@
 #include "MathHelpers.h"
 #include <absl/algorithm/container.h>
 #include <absl/types/span.h>
+#include <array>
 #include <cmath>
+#include <cstdint>
 
 namespace sfz
 {
@@ -184,8 +186,9 @@ template <class T>
 inline void snippetLoopingIndex(const T*& jump, T*& leftCoeff, T*& rightCoeff, int*& index, T& floatIndex, T loopEnd, T loopStart)
 {
     floatIndex += *jump;
+    // The jump may span more than one loop period for short loops and high pitch ratios
     if (floatIndex >= loopEnd)
-        floatIndex -= loopEnd - loopStart;
+        floatIndex = loopStart + std::fmod(floatIndex - loopStart, loopEnd - loopStart);
     *index = static_cast<int>(floatIndex);
     *rightCoeff = floatIndex - *index;
     *leftCoeff = 1.0f - *rightCoeff;
@@ -217,6 +220,229 @@ float loopingSFZIndex(absl::Span<const T> jumps, absl::Span<T> leftCoeffs, absl:
 template <>
 float loopingSFZIndex<float, true>(absl::Span<const float> jumps, absl::Span<float> leftCoeff, absl::Span<float> rightCoeff, absl::Span<int> indices, float floatIndex, float loopEnd, float loopStart) noexcept;
 
+// Playback positions in 32.32 fixed point: the upper 32 bits hold the sample
+// index and the lower 32 bits the fractional position between two samples.
+constexpr uint64_t fixedPointOne { uint64_t { 1 } << 32 };
+// Only the upper 24 bits of the fractional part are kept for the coefficients,
+// so that they convert exactly to float
+constexpr float fixedPointFraction { 1.0f / (1 << 24) };
+
+template <class T>
+inline uint64_t toFixedPoint(T value) noexcept
+{
+    ASSERT(value >= 0);
+    return static_cast<uint64_t>(static_cast<double>(value) * static_cast<double>(fixedPointOne) + 0.5);
+}
+
+template <class T>
+inline void snippetFixedPointIndex(uint64_t position, T*& leftCoeff, T*& rightCoeff, int*& index)
+{
+    *index++ = static_cast<int>(position >> 32);
+    const auto fraction = static_cast<T>(static_cast<uint32_t>(position) >> 8) * static_cast<T>(fixedPointFraction);
+    *rightCoeff++ = fraction;
+    *leftCoeff++ = static_cast<T>(1.0) - fraction;
+}
+
+/**
+ * @brief Compute the indices and coefficients of a constant speed playback from
+ * a 32.32 fixed point position and step. As with the SFZ index functions, the
+ * position is advanced before each frame.
+ *
+ * @return the position of the last frame
+ */
+template <class T, bool SIMD = SIMDConfig::fixedPointIndex>
+uint64_t fixedPointIndex(absl::Span<T> leftCoeffs, absl::Span<T> rightCoeffs, absl::Span<int> indices, uint64_t position, uint64_t step) noexcept
+{
+    ASSERT(indices.size() == leftCoeffs.size());
+    ASSERT(indices.size() == rightCoeffs.size());
+    auto* index = indices.begin();
+    auto* leftCoeff = leftCoeffs.begin();
+    auto* rightCoeff = rightCoeffs.begin();
+    auto* sentinel = index + min(indices.size(), leftCoeffs.size(), rightCoeffs.size());
+    while (index < sentinel) {
+        position += step;
+        snippetFixedPointIndex<T>(position, leftCoeff, rightCoeff, index);
+    }
+    return position;
+}
+
+template <>
+uint64_t fixedPointIndex<float, true>(absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs, absl::Span<int> indices, uint64_t position, uint64_t step) noexcept;
+
+/**
+ * @brief Fixed point version of saturatingSFZIndex: once the position reaches
+ * the end, the remaining frames read the last sample.
+ */
+template <class T, bool SIMD = SIMDConfig::fixedPointIndex>
+uint64_t saturatingFixedPointIndex(absl::Span<T> leftCoeffs, absl::Span<T> rightCoeffs, absl::Span<int> indices, uint64_t position, uint64_t step, uint64_t end) noexcept
+{
+    ASSERT(end >= fixedPointOne);
+    const auto size = min(indices.size(), leftCoeffs.size(), rightCoeffs.size());
+    uint64_t rampSize = size;
+    if (position >= end)
+        rampSize = 0;
+    else if (step > 0)
+        rampSize = min<uint64_t>(rampSize, (end - position - 1) / step);
+
+    const auto ramp = static_cast<size_t>(rampSize);
+    position = fixedPointIndex<T, SIMD>(leftCoeffs.first(ramp), rightCoeffs.first(ramp), indices.first(ramp), position, step);
+    if (ramp < size) {
+        fill<int>(indices.subspan(ramp, size - ramp), static_cast<int>(end >> 32) - 1);
+        fill<T>(leftCoeffs.subspan(ramp, size - ramp), static_cast<T>(0.0));
+        fill<T>(rightCoeffs.subspan(ramp, size - ramp), static_cast<T>(1.0));
+        position = end;
+    }
+    return position;
+}
+
+/**
+ * @brief Fixed point version of loopingSFZIndex. The frames between two wrap
+ * arounds are computed as a single ramp, and the wrap itself is an exact
+ * integer modulo so the loop never drifts.
+ */
+template <class T, bool SIMD = SIMDConfig::fixedPointIndex>
+uint64_t loopingFixedPointIndex(absl::Span<T> leftCoeffs, absl::Span<T> rightCoeffs, absl::Span<int> indices, uint64_t position, uint64_t step, uint64_t loopEnd, uint64_t loopStart) noexcept
+{
+    ASSERT(loopStart < loopEnd);
+    const auto size = min(indices.size(), leftCoeffs.size(), rightCoeffs.size());
+    const auto period = loopEnd - loopStart;
+    size_t frame = 0;
+    while (frame < size) {
+        uint64_t rampSize = size - frame;
+        if (position >= loopEnd)
+            rampSize = 0;
+        else if (step > 0)
+            rampSize = min<uint64_t>(rampSize, (loopEnd - position - 1) / step);
+
+        const auto ramp = static_cast<size_t>(rampSize);
+        position = fixedPointIndex<T, SIMD>(leftCoeffs.subspan(frame, ramp), rightCoeffs.subspan(frame, ramp), indices.subspan(frame, ramp), position, step);
+        frame += ramp;
+        if (frame == size)
+            break;
+
+        // The jump may span more than one loop period for short loops and high pitch ratios
+        position = loopStart + (position + step - loopStart) % period;
+        auto* leftCoeff = &leftCoeffs[frame];
+        auto* rightCoeff = &rightCoeffs[frame];
+        auto* index = &indices[frame];
+        snippetFixedPointIndex<T>(position, leftCoeff, rightCoeff, index);
+        frame++;
+    }
+    return position;
+}
+
+template <class T>
+inline void snippetLinearInterpolation(const T* source, const int*& index, const T*& leftCoeff, const T*& rightCoeff, T*& output)
+{
+    *output++ = source[*index] * (*leftCoeff++) + source[*index + 1] * (*rightCoeff++);
+    index++;
+}
+
+/**
+ * @brief Linear interpolation of a source at the positions given by the indices
+ * and the left/right coefficients, as computed by the SFZ index functions.
+ *
+ * The source must hold at least index + 1 elements for every index.
+ */
+template <class T, bool SIMD = SIMDConfig::linearInterpolation>
+void linearInterpolation(absl::Span<const T> source, absl::Span<const int> indices, absl::Span<const T> leftCoeffs, absl::Span<const T> rightCoeffs, absl::Span<T> output) noexcept
+{
+    ASSERT(leftCoeffs.size() == indices.size());
+    ASSERT(rightCoeffs.size() == indices.size());
+    ASSERT(output.size() >= indices.size());
+    auto* index = indices.begin();
+    auto* leftCoeff = leftCoeffs.begin();
+    auto* rightCoeff = rightCoeffs.begin();
+    auto* out = output.begin();
+    auto* sentinel = index + min(indices.size(), leftCoeffs.size(), rightCoeffs.size(), output.size());
+    while (index < sentinel)
+        snippetLinearInterpolation<T>(source.data(), index, leftCoeff, rightCoeff, out);
+}
+
+template <class T>
+inline void snippetLinearInterpolation(const T* sourceLeft, const T* sourceRight, const int*& index, const T*& leftCoeff, const T*& rightCoeff, T*& outputLeft, T*& outputRight)
+{
+    *outputLeft++ = sourceLeft[*index] * (*leftCoeff) + sourceLeft[*index + 1] * (*rightCoeff);
+    *outputRight++ = sourceRight[*index] * (*leftCoeff++) + sourceRight[*index + 1] * (*rightCoeff++);
+    index++;
+}
+
+/**
+ * @brief Stereo version of the linear interpolation, sharing the indices and
+ * coefficients between both channels.
+ */
+template <class T, bool SIMD = SIMDConfig::linearInterpolation>
+void linearInterpolation(absl::Span<const T> sourceLeft, absl::Span<const T> sourceRight, absl::Span<const int> indices, absl::Span<const T> leftCoeffs, absl::Span<const T> rightCoeffs, absl::Span<T> outputLeft, absl::Span<T> outputRight) noexcept
+{
+    ASSERT(sourceLeft.size() == sourceRight.size());
+    ASSERT(leftCoeffs.size() == indices.size());
+    ASSERT(rightCoeffs.size() == indices.size());
+    ASSERT(outputLeft.size() >= indices.size());
+    ASSERT(outputRight.size() >= indices.size());
+    auto* index = indices.begin();
+    auto* leftCoeff = leftCoeffs.begin();
+    auto* rightCoeff = rightCoeffs.begin();
+    auto* outLeft = outputLeft.begin();
+    auto* outRight = outputRight.begin();
+    auto* sentinel = index + min(min(indices.size(), leftCoeffs.size(), rightCoeffs.size()), outputLeft.size(), outputRight.size());
+    while (index < sentinel)
+        snippetLinearInterpolation<T>(sourceLeft.data(), sourceRight.data(), index, leftCoeff, rightCoeff, outLeft, outRight);
+}
+
+template <>
+void linearInterpolation<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> output) noexcept;
+
+template <>
+void linearInterpolation<float, true>(absl::Span<const float> sourceLeft, absl::Span<const float> sourceRight, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept;
+
+template <class T>
+inline T snippetWavetable(const T* table, uint64_t& position, uint64_t step, uint64_t wrapMask)
+{
+    position = (position + step) & wrapMask;
+    const auto index = static_cast<int>(position >> 32);
+    const auto fraction = static_cast<T>(static_cast<uint32_t>(position) >> 8) * static_cast<T>(fixedPointFraction);
+    return table[index] * (static_cast<T>(1.0) - fraction) + table[index + 1] * fraction;
+}
+
+/**
+ * @brief Render a batch of wavetable oscillators and add their sum to a mono output.
+ *
+ * The oscillators are passed as a structure of arrays, one entry per voice. The
+ * tables hold a power of 2 number of frames plus a guard frame, so that the 32.32
+ * fixed point positions wrap with a mask. As with the fixed point index functions,
+ * the positions are advanced before each frame and the interpolation is linear.
+ *
+ * @param tables the table of each voice, holding tableSize + 1 frames
+ * @param positions the position of each voice, updated to the position of the last frame
+ * @param steps the fixed point step of each voice
+ * @param gains the gain buffer of each voice, at least as long as the output
+ * @param powers the sum of the squared output of each voice is added there
+ * @param output the mono output
+ * @param tableSize the size of the tables, a power of 2
+ */
+template <class T, bool SIMD = SIMDConfig::wavetableBatch>
+void wavetableBatch(absl::Span<const T* const> tables, absl::Span<uint64_t> positions, absl::Span<const uint64_t> steps, absl::Span<const T* const> gains, absl::Span<T> powers, absl::Span<T> output, int tableSize) noexcept
+{
+    ASSERT(tables.size() == positions.size());
+    ASSERT(tables.size() == steps.size());
+    ASSERT(tables.size() == gains.size());
+    ASSERT(tables.size() == powers.size());
+    ASSERT(tableSize > 0 && (tableSize & (tableSize - 1)) == 0);
+    const auto wrapMask = (static_cast<uint64_t>(tableSize) << 32) - 1;
+    const auto numVoices = min(tables.size(), positions.size(), steps.size(), gains.size());
+    for (size_t voice = 0; voice < numVoices; ++voice) {
+        const auto* gain = gains[voice];
+        for (auto& out : output) {
+            const auto value = snippetWavetable<T>(tables[voice], positions[voice], steps[voice], wrapMask) * (*gain++);
+            out += value;
+            powers[voice] += value * value;
+        }
+    }
+}
+
+template <>
+void wavetableBatch<float, true>(absl::Span<const float* const> tables, absl::Span<uint64_t> positions, absl::Span<const uint64_t> steps, absl::Span<const float* const> gains, absl::Span<float> powers, absl::Span<float> output, int tableSize) noexcept;
+
 template <class T>
 inline void snippetGain(T gain, const T*& input, T*& output)
 {
@@ -293,6 +519,106 @@ void multiplyAdd(absl::Span<const T> gain, absl::Span<const T> input, absl::Span
 template <>
 void multiplyAdd<float, true>(absl::Span<const float> gain, absl::Span<const float> input, absl::Span<float> output) noexcept;
 
+template <class T>
+inline T snippetMonoMix(const T*& gain, const T*& panCos, const T*& panSin, const T*& input, T*& left, T*& right)
+{
+    const auto value = (*gain++) * (*input++);
+    const auto leftValue = (*panCos++) * value;
+    const auto rightValue = (*panSin++) * value;
+    *left++ += leftValue;
+    *right++ += rightValue;
+    return leftValue * leftValue + rightValue * rightValue;
+}
+
+/**
+ * @brief Applies a gain and pan coefficients to a mono input and adds it to a stereo output
+ *
+ * outputLeft += gain * panCos * input, outputRight += gain * panSin * input
+ *
+ * @return the mean squared value of the added signal, averaged over both channels
+ */
+template <class T, bool SIMD = SIMDConfig::monoMix>
+T monoMix(absl::Span<const T> gain, absl::Span<const T> panCos, absl::Span<const T> panSin, absl::Span<const T> input, absl::Span<T> outputLeft, absl::Span<T> outputRight) noexcept
+{
+    ASSERT(gain.size() == input.size());
+    ASSERT(panCos.size() == input.size());
+    ASSERT(panSin.size() == input.size());
+    ASSERT(input.size() <= outputLeft.size());
+    ASSERT(input.size() <= outputRight.size());
+    auto* g = gain.begin();
+    auto* pc = panCos.begin();
+    auto* ps = panSin.begin();
+    auto* in = input.begin();
+    auto* left = outputLeft.begin();
+    auto* right = outputRight.begin();
+    const auto size = min(min(gain.size(), panCos.size(), panSin.size()), input.size(), outputLeft.size(), outputRight.size());
+    auto* sentinel = in + size;
+    T power { 0.0 };
+    while (in < sentinel)
+        power += snippetMonoMix<T>(g, pc, ps, in, left, right);
+
+    return size > 0 ? power / static_cast<T>(2 * size) : power;
+}
+
+template <>
+float monoMix<float, true>(absl::Span<const float> gain, absl::Span<const float> panCos, absl::Span<const float> panSin, absl::Span<const float> input, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept;
+
+template <class T>
+inline T snippetStereoMix(const T*& gain, const T*& widthCos, const T*& widthSin, const T*& positionCos, const T*& positionSin, const T*& inputLeft, const T*& inputRight, T*& left, T*& right)
+{
+    const auto halfGain = static_cast<T>(0.5) * (*gain++);
+    const auto mid = (*widthSin++) * (*inputLeft + *inputRight);
+    const auto side = (*widthCos++) * (*inputLeft++ - *inputRight++);
+    const auto leftValue = halfGain * (mid + (*positionCos++) * side);
+    const auto rightValue = halfGain * (mid + (*positionSin++) * side);
+    *left++ += leftValue;
+    *right++ += rightValue;
+    return leftValue * leftValue + rightValue * rightValue;
+}
+
+/**
+ * @brief Applies a gain, a stereo width and a position to a stereo input and adds it to a stereo output
+ *
+ * This is the fused version of the mid/side processing: the input is split in
+ * mid = (L + R) / sqrt(2) and side = (L - R) / sqrt(2), the width coefficients
+ * scale side and mid respectively and the position coefficients pan the side
+ * channel, before a final 1 / sqrt(2) normalization.
+ *
+ * @return the mean squared value of the added signal, averaged over both channels
+ */
+template <class T, bool SIMD = SIMDConfig::stereoMix>
+T stereoMix(absl::Span<const T> gain, absl::Span<const T> widthCos, absl::Span<const T> widthSin, absl::Span<const T> positionCos, absl::Span<const T> positionSin, absl::Span<const T> inputLeft, absl::Span<const T> inputRight, absl::Span<T> outputLeft, absl::Span<T> outputRight) noexcept
+{
+    ASSERT(gain.size() == inputLeft.size());
+    ASSERT(widthCos.size() == inputLeft.size());
+    ASSERT(widthSin.size() == inputLeft.size());
+    ASSERT(positionCos.size() == inputLeft.size());
+    ASSERT(positionSin.size() == inputLeft.size());
+    ASSERT(inputRight.size() == inputLeft.size());
+    ASSERT(inputLeft.size() <= outputLeft.size());
+    ASSERT(inputLeft.size() <= outputRight.size());
+    auto* g = gain.begin();
+    auto* wc = widthCos.begin();
+    auto* ws = widthSin.begin();
+    auto* pc = positionCos.begin();
+    auto* ps = positionSin.begin();
+    auto* inLeft = inputLeft.begin();
+    auto* inRight = inputRight.begin();
+    auto* left = outputLeft.begin();
+    auto* right = outputRight.begin();
+    const auto size = min(min(gain.size(), widthCos.size(), widthSin.size(), positionCos.size()),
+        min(positionSin.size(), inputLeft.size(), inputRight.size()), outputLeft.size(), outputRight.size());
+    auto* sentinel = inLeft + size;
+    T power { 0.0 };
+    while (inLeft < sentinel)
+        power += snippetStereoMix<T>(g, wc, ws, pc, ps, inLeft, inRight, left, right);
+
+    return size > 0 ? power / static_cast<T>(2 * size) : power;
+}
+
+template <>
+float stereoMix<float, true>(absl::Span<const float> gain, absl::Span<const float> widthCos, absl::Span<const float> widthSin, absl::Span<const float> positionCos, absl::Span<const float> positionSin, absl::Span<const float> inputLeft, absl::Span<const float> inputRight, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept;
+
 template <class T>
 inline void snippetRampLinear(T*& output, T& value, T step)
 {
@@ -452,6 +778,35 @@ void pan(absl::Span<const T> panEnvelope, absl::Span<T> leftBuffer, absl::Span<T
 template <>
 void pan<float, true>(absl::Span<const float> panEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept;
 
+template <class T>
+inline void snippetPanLaw(const T*& pan, T*& cosOutput, T*& sinOutput)
+{
+    const auto circlePan = piFour<T> * (static_cast<T>(1.0) + clamp<T>(*pan++, -1.0, 1.0));
+    *cosOutput++ = std::cos(circlePan);
+    *sinOutput++ = std::sin(circlePan);
+}
+
+/**
+ * @brief Computes the equal-power pan law gains cos(pi/4 (1 + pan)) and
+ * sin(pi/4 (1 + pan)) for a pan envelope between -1 and 1. Values outside
+ * this range are clamped.
+ */
+template <class T, bool SIMD = SIMDConfig::panLaw>
+void panLaw(absl::Span<const T> panEnvelope, absl::Span<T> cosOutput, absl::Span<T> sinOutput) noexcept
+{
+    ASSERT(cosOutput.size() >= panEnvelope.size());
+    ASSERT(sinOutput.size() >= panEnvelope.size());
+    auto* pan = panEnvelope.begin();
+    auto* cosOut = cosOutput.begin();
+    auto* sinOut = sinOutput.begin();
+    auto* sentinel = pan + min(panEnvelope.size(), cosOutput.size(), sinOutput.size());
+    while (pan < sentinel)
+        snippetPanLaw(pan, cosOut, sinOut);
+}
+
+template <>
+void panLaw<float, true>(absl::Span<const float> panEnvelope, absl::Span<float> cosOutput, absl::Span<float> sinOutput) noexcept;
+
 template <class T, bool SIMD = SIMDConfig::mean>
 T mean(absl::Span<const T> vector) noexcept
 {
@@ -546,6 +901,159 @@ void sfzInterpolationCast(absl::Span<const T> floatJumps, absl::Span<int> jumps,
 template<>
 void sfzInterpolationCast<float, true>(absl::Span<const float> floatJumps, absl::Span<int> jumps, absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs) noexcept;
 
+/**
+ * @brief 4-point, 3rd order Hermite interpolation between x0 and x1 at the
+ * fractional position t.
+ */
+template <class T>
+inline T hermite4(T xm1, T x0, T x1, T x2, T t)
+{
+    const T c = (x1 - xm1) * static_cast<T>(0.5);
+    const T v = x0 - x1;
+    const T w = c + v;
+    const T a = w + v + (x2 - x0) * static_cast<T>(0.5);
+    const T bNeg = w + a;
+    return ((a * t - bNeg) * t + c) * t + x0;
+}
+
+template <class T>
+inline void snippetHermiteInterpolation(const T* source, int sourceSize, const int*& index, const T*& coeff, T*& output)
+{
+    const int i = *index++;
+    const T t = *coeff++;
+    if (i >= 1 && i + 2 < sourceSize) {
+        *output++ = hermite4(source[i - 1], source[i], source[i + 1], source[i + 2], t);
+        return;
+    }
+
+    // Repeat the edge samples when the neighbours fall outside the source
+    const auto at = [&](int j) { return source[clamp(j, 0, sourceSize - 1)]; };
+    *output++ = hermite4(at(i - 1), at(i), at(i + 1), at(i + 2), t);
+}
+
+/**
+ * @brief Hermite interpolation of a source at the positions given by the indices
+ * and the right coefficients, as computed by the SFZ index functions. The
+ * interpolation reads one frame before and two frames after each index; frames
+ * outside of the source repeat its first or last value.
+ */
+template <class T, bool SIMD = SIMDConfig::hermiteInterpolation>
+void hermiteInterpolation(absl::Span<const T> source, absl::Span<const int> indices, absl::Span<const T> coeffs, absl::Span<T> output) noexcept
+{
+    ASSERT(coeffs.size() == indices.size());
+    ASSERT(output.size() >= indices.size());
+    auto* index = indices.begin();
+    auto* coeff = coeffs.begin();
+    auto* out = output.begin();
+    auto* sentinel = index + min(indices.size(), coeffs.size(), output.size());
+    const auto sourceSize = static_cast<int>(source.size());
+    while (index < sentinel)
+        snippetHermiteInterpolation<T>(source.data(), sourceSize, index, coeff, out);
+}
+
+template <>
+void hermiteInterpolation<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept;
+
+/**
+ * @brief Blackman-windowed sinc kernels tabulated over the fractional position.
+ *
+ * Row p holds the Taps coefficients for a fractional position of p / phases,
+ * applied to the source frames from index - Taps / 2 + 1 to index + Taps / 2.
+ * An extra row covers the fractional position 1, and every row is normalized
+ * to a unit gain at DC.
+ */
+template <class T, int Taps>
+class WindowedSincTable {
+public:
+    static_assert(Taps % 4 == 0, "The number of taps must be a multiple of 4");
+    static constexpr int taps { Taps };
+    static constexpr int phases { 256 };
+
+    static const WindowedSincTable& get() noexcept
+    {
+        static const WindowedSincTable table;
+        return table;
+    }
+
+    const T* row(int phase) const noexcept { return &data[phase * Taps]; }
+
+private:
+    WindowedSincTable() noexcept
+    {
+        constexpr double halfWidth { Taps / 2 };
+        for (int phase = 0; phase <= phases; ++phase) {
+            const double position = static_cast<double>(phase) / phases;
+            double kernel[Taps];
+            double sum { 0.0 };
+            for (int tap = 0; tap < Taps; ++tap) {
+                const double x = tap - (halfWidth - 1) - position;
+                const double sinc = x == 0.0 ? 1.0 : std::sin(pi<double> * x) / (pi<double> * x);
+                const double window = 0.42 + 0.5 * std::cos(pi<double> * x / halfWidth) + 0.08 * std::cos(twoPi<double> * x / halfWidth);
+                kernel[tap] = sinc * window;
+                sum += kernel[tap];
+            }
+            for (int tap = 0; tap < Taps; ++tap)
+                data[phase * Taps + tap] = static_cast<T>(kernel[tap] / sum);
+        }
+    }
+
+    alignas(SIMDConfig::defaultAlignment) std::array<T, (phases + 1) * Taps> data;
+};
+
+template <class T, int Taps>
+inline void snippetSincInterpolation(const T* source, int sourceSize, const WindowedSincTable<T, Taps>& table, const int*& index, const T*& coeff, T*& output)
+{
+    constexpr int phases { WindowedSincTable<T, Taps>::phases };
+    const T position = *coeff++ * phases;
+    const int phase = min(static_cast<int>(position), phases - 1);
+    const T mix = position - static_cast<T>(phase);
+    const T* row0 = table.row(phase);
+    const T* row1 = table.row(phase + 1);
+    const int first = *index++ - Taps / 2 + 1;
+
+    T sum { 0 };
+    if (first >= 0 && first + Taps <= sourceSize) {
+        for (int tap = 0; tap < Taps; ++tap)
+            sum += (row0[tap] + mix * (row1[tap] - row0[tap])) * source[first + tap];
+    } else {
+        // Repeat the edge samples when the kernel spans outside the source
+        for (int tap = 0; tap < Taps; ++tap)
+            sum += (row0[tap] + mix * (row1[tap] - row0[tap])) * source[clamp(first + tap, 0, sourceSize - 1)];
+    }
+    *output++ = sum;
+}
+
+/**
+ * @brief Windowed sinc interpolation of a source at the positions given by the
+ * indices and the right coefficients, as computed by the SFZ index functions.
+ * The kernel spans either 8 or 16 source frames around each index; frames
+ * outside of the source repeat its first or last value.
+ */
+template <class T, bool SIMD = SIMDConfig::sincInterpolation>
+void sincInterpolation(absl::Span<const T> source, absl::Span<const int> indices, absl::Span<const T> coeffs, absl::Span<T> output, int taps) noexcept
+{
+    ASSERT(taps == 8 || taps == 16);
+    ASSERT(coeffs.size() == indices.size());
+    ASSERT(output.size() >= indices.size());
+    auto* index = indices.begin();
+    auto* coeff = coeffs.begin();
+    auto* out = output.begin();
+    auto* sentinel = index + min(indices.size(), coeffs.size(), output.size());
+    const auto sourceSize = static_cast<int>(source.size());
+    const auto interpolate = [&](const auto& table) {
+        while (index < sentinel)
+            snippetSincInterpolation(source.data(), sourceSize, table, index, coeff, out);
+    };
+
+    if (taps > 8)
+        interpolate(WindowedSincTable<T, 16>::get());
+    else
+        interpolate(WindowedSincTable<T, 8>::get());
+}
+
+template <>
+void sincInterpolation<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output, int taps) noexcept;
+
 template <class T>
 inline void snippetDiff(const T*& input, T*& output)
 {
@@ -32,6 +32,10 @@
 #include <intrin.h>
 #endif
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #include "mathfuns/sse_mathfun.h"
 
 using Type = float;
@@ -75,6 +79,13 @@ bool unaligned(const float* ptr1, const float* ptr2, const float* ptr3, const fl
     return unaligned(ptr1) || unaligned(ptr2) || unaligned(ptr3) || unaligned(ptr4);
 }
 
+// Without a hardware gather we load the 4 values by hand, which still lets
+// the interpolation itself and the stores run 4 frames at a time.
+inline __m128 gatherSSE(const float* source, const int* index)
+{
+    return _mm_setr_ps(source[index[0]], source[index[1]], source[index[2]], source[index[3]]);
+}
+
 template <>
 void sfz::readInterleaved<float, true>(absl::Span<const float> input, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
 {
@@ -330,6 +341,120 @@ void sfz::multiplyAdd<float, true>(absl::Span<const float> gain, absl::Span<cons
         snippetMultiplyAdd<float>(g, in, out);
 }
 
+template <>
+float sfz::monoMix<float, true>(absl::Span<const float> gain, absl::Span<const float> panCos, absl::Span<const float> panSin, absl::Span<const float> input, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
+{
+    ASSERT(gain.size() == input.size());
+    ASSERT(panCos.size() == input.size());
+    ASSERT(panSin.size() == input.size());
+    ASSERT(input.size() <= outputLeft.size());
+    ASSERT(input.size() <= outputRight.size());
+    auto* g = gain.begin();
+    auto* pc = panCos.begin();
+    auto* ps = panSin.begin();
+    auto* in = input.begin();
+    auto* left = outputLeft.begin();
+    auto* right = outputRight.begin();
+    const auto size = min(min(gain.size(), panCos.size(), panSin.size()), input.size(), outputLeft.size(), outputRight.size());
+    if (size == 0)
+        return 0.0f;
+
+    // With this many streams there is little chance that they share the same
+    // alignment, so we use unaligned accesses throughout.
+    auto* sentinel = in + size;
+    auto* lastVector = in + (size & ~TypeAlignmentMask);
+    auto mmPower = _mm_setzero_ps();
+    while (in < lastVector) {
+        const auto mmValue = _mm_mul_ps(_mm_loadu_ps(g), _mm_loadu_ps(in));
+        const auto mmLeft = _mm_mul_ps(_mm_loadu_ps(pc), mmValue);
+        const auto mmRight = _mm_mul_ps(_mm_loadu_ps(ps), mmValue);
+        _mm_storeu_ps(left, _mm_add_ps(_mm_loadu_ps(left), mmLeft));
+        _mm_storeu_ps(right, _mm_add_ps(_mm_loadu_ps(right), mmRight));
+        mmPower = _mm_add_ps(mmPower, _mm_add_ps(_mm_mul_ps(mmLeft, mmLeft), _mm_mul_ps(mmRight, mmRight)));
+        g += TypeAlignment;
+        pc += TypeAlignment;
+        ps += TypeAlignment;
+        in += TypeAlignment;
+        left += TypeAlignment;
+        right += TypeAlignment;
+    }
+
+    std::array<float, 4> sseResult;
+    _mm_storeu_ps(sseResult.data(), mmPower);
+    float power { 0.0f };
+    for (auto sseValue : sseResult)
+        power += sseValue;
+
+    while (in < sentinel)
+        power += snippetMonoMix<float>(g, pc, ps, in, left, right);
+
+    return power / static_cast<float>(2 * size);
+}
+
+template <>
+float sfz::stereoMix<float, true>(absl::Span<const float> gain, absl::Span<const float> widthCos, absl::Span<const float> widthSin, absl::Span<const float> positionCos, absl::Span<const float> positionSin, absl::Span<const float> inputLeft, absl::Span<const float> inputRight, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
+{
+    ASSERT(gain.size() == inputLeft.size());
+    ASSERT(widthCos.size() == inputLeft.size());
+    ASSERT(widthSin.size() == inputLeft.size());
+    ASSERT(positionCos.size() == inputLeft.size());
+    ASSERT(positionSin.size() == inputLeft.size());
+    ASSERT(inputRight.size() == inputLeft.size());
+    ASSERT(inputLeft.size() <= outputLeft.size());
+    ASSERT(inputLeft.size() <= outputRight.size());
+    auto* g = gain.begin();
+    auto* wc = widthCos.begin();
+    auto* ws = widthSin.begin();
+    auto* pc = positionCos.begin();
+    auto* ps = positionSin.begin();
+    auto* inLeft = inputLeft.begin();
+    auto* inRight = inputRight.begin();
+    auto* left = outputLeft.begin();
+    auto* right = outputRight.begin();
+    const auto size = min(min(gain.size(), widthCos.size(), widthSin.size(), positionCos.size()),
+        min(positionSin.size(), inputLeft.size(), inputRight.size()), outputLeft.size(), outputRight.size());
+    if (size == 0)
+        return 0.0f;
+
+    // See monoMix regarding the unaligned accesses
+    auto* sentinel = inLeft + size;
+    auto* lastVector = inLeft + (size & ~TypeAlignmentMask);
+    const auto mmHalf = _mm_set_ps1(0.5f);
+    auto mmPower = _mm_setzero_ps();
+    while (inLeft < lastVector) {
+        const auto mmInLeft = _mm_loadu_ps(inLeft);
+        const auto mmInRight = _mm_loadu_ps(inRight);
+        const auto mmHalfGain = _mm_mul_ps(mmHalf, _mm_loadu_ps(g));
+        const auto mmMid = _mm_mul_ps(_mm_loadu_ps(ws), _mm_add_ps(mmInLeft, mmInRight));
+        const auto mmSide = _mm_mul_ps(_mm_loadu_ps(wc), _mm_sub_ps(mmInLeft, mmInRight));
+        const auto mmLeft = _mm_mul_ps(mmHalfGain, _mm_add_ps(mmMid, _mm_mul_ps(_mm_loadu_ps(pc), mmSide)));
+        const auto mmRight = _mm_mul_ps(mmHalfGain, _mm_add_ps(mmMid, _mm_mul_ps(_mm_loadu_ps(ps), mmSide)));
+        _mm_storeu_ps(left, _mm_add_ps(_mm_loadu_ps(left), mmLeft));
+        _mm_storeu_ps(right, _mm_add_ps(_mm_loadu_ps(right), mmRight));
+        mmPower = _mm_add_ps(mmPower, _mm_add_ps(_mm_mul_ps(mmLeft, mmLeft), _mm_mul_ps(mmRight, mmRight)));
+        g += TypeAlignment;
+        wc += TypeAlignment;
+        ws += TypeAlignment;
+        pc += TypeAlignment;
+        ps += TypeAlignment;
+        inLeft += TypeAlignment;
+        inRight += TypeAlignment;
+        left += TypeAlignment;
+        right += TypeAlignment;
+    }
+
+    std::array<float, 4> sseResult;
+    _mm_storeu_ps(sseResult.data(), mmPower);
+    float power { 0.0f };
+    for (auto sseValue : sseResult)
+        power += sseValue;
+
+    while (inLeft < sentinel)
+        power += snippetStereoMix<float>(g, wc, ws, pc, ps, inLeft, inRight, left, right);
+
+    return power / static_cast<float>(2 * size);
+}
+
 template <>
 float sfz::loopingSFZIndex<float, true>(absl::Span<const float> jumps,
     absl::Span<float> leftCoeffs,
@@ -355,7 +480,9 @@ float sfz::loopingSFZIndex<float, true>(absl::Span<const float> jumps,
         snippetLoopingIndex<float>(jump, leftCoeff, rightCoeff, index, floatIndex, loopEnd, loopStart);
 
     auto mmFloatIndex = _mm_set_ps1(floatIndex);
-    const auto mmJumpBack = _mm_set1_ps(loopEnd - loopStart);
+    const auto mmLoopLength = _mm_set1_ps(loopEnd - loopStart);
+    const auto mmLoopLengthInv = _mm_set1_ps(1.0f / (loopEnd - loopStart));
+    const auto mmLoopStart = _mm_set1_ps(loopStart);
     const auto mmLoopEnd = _mm_set1_ps(loopEnd);
     while (jump < alignedEnd) {
         auto mmOffset = _mm_load_ps(jump);
@@ -364,12 +491,19 @@ float sfz::loopingSFZIndex<float, true>(absl::Span<const float> jumps,
 
         mmFloatIndex = _mm_add_ps(mmFloatIndex, mmOffset);
         const auto mmCompared = _mm_cmpge_ps(mmFloatIndex, mmLoopEnd);
-        auto mmLoopBack = _mm_sub_ps(mmFloatIndex, mmJumpBack);
-        mmLoopBack = _mm_and_ps(mmCompared, mmLoopBack);
-        mmFloatIndex = _mm_andnot_ps(mmCompared, mmFloatIndex);
-        mmFloatIndex = _mm_add_ps(mmFloatIndex, mmLoopBack);
-
-        auto mmIndices = _mm_cvtps_epi32(_mm_sub_ps(mmFloatIndex, _mm_set_ps1(0.4999999552965164184570312f)));
+        if (_mm_movemask_ps(mmCompared) != 0) {
+            // Bring the wrapped positions back in the loop, however many periods they went over
+            const auto mmFromStart = _mm_sub_ps(mmFloatIndex, mmLoopStart);
+            const auto mmPeriods = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(mmFromStart, mmLoopLengthInv)));
+            auto mmLoopBack = _mm_sub_ps(mmFloatIndex, _mm_mul_ps(mmPeriods, mmLoopLength));
+            // Correct rounding errors on the period count
+            mmLoopBack = _mm_sub_ps(mmLoopBack, _mm_and_ps(_mm_cmpge_ps(mmLoopBack, mmLoopEnd), mmLoopLength));
+            mmLoopBack = _mm_add_ps(mmLoopBack, _mm_and_ps(_mm_cmplt_ps(mmLoopBack, mmLoopStart), mmLoopLength));
+            mmFloatIndex = _mm_or_ps(_mm_andnot_ps(mmCompared, mmFloatIndex), _mm_and_ps(mmCompared, mmLoopBack));
+        }
+
+        // Positions are non-negative so truncating gives the integer part
+        auto mmIndices = _mm_cvttps_epi32(mmFloatIndex);
         _mm_store_si128(reinterpret_cast<__m128i*>(index), mmIndices);
 
         auto mmRight = _mm_sub_ps(mmFloatIndex, _mm_cvtepi32_ps(mmIndices));
@@ -417,21 +551,26 @@ float sfz::saturatingSFZIndex<float, true>(absl::Span<const float> jumps,
 
     auto mmFloatIndex = _mm_set_ps1(floatIndex);
     const auto mmLoopEnd = _mm_set1_ps(loopEnd);
-    const auto mmSaturated = _mm_sub_ps(mmLoopEnd, _mm_set_ps1(0.000001f));
+    // Saturated positions read the last frame with a unit right coefficient, like the scalar version
+    const auto mmSaturatedIndex = _mm_set1_epi32(static_cast<int>(loopEnd) - 1);
+    const auto mmOne = _mm_set_ps1(1.0f);
     while (jump < alignedEnd) {
         auto mmOffset = _mm_load_ps(jump);
         mmOffset = _mm_add_ps(mmOffset, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(mmOffset), 4)));
         mmOffset = _mm_add_ps(mmOffset, _mm_shuffle_ps(_mm_setzero_ps(), mmOffset, 0x40));
 
-        mmFloatIndex = _mm_add_ps(mmFloatIndex, mmOffset);
+        mmFloatIndex = _mm_min_ps(_mm_add_ps(mmFloatIndex, mmOffset), mmLoopEnd);
         const auto mmCompared = _mm_cmplt_ps(mmFloatIndex, mmLoopEnd);
-        mmFloatIndex = _mm_add_ps(_mm_and_ps(mmCompared, mmFloatIndex), _mm_andnot_ps(mmCompared, mmSaturated));
 
-        auto mmIndices = _mm_cvtps_epi32(_mm_sub_ps(mmFloatIndex, _mm_set_ps1(0.4999999552965164184570312f)));
+        // Positions are non-negative so truncating gives the integer part
+        auto mmIndices = _mm_cvttps_epi32(mmFloatIndex);
+        auto mmRight = _mm_sub_ps(mmFloatIndex, _mm_cvtepi32_ps(mmIndices));
+        const auto mmComparedInt = _mm_castps_si128(mmCompared);
+        mmIndices = _mm_or_si128(_mm_and_si128(mmComparedInt, mmIndices), _mm_andnot_si128(mmComparedInt, mmSaturatedIndex));
+        mmRight = _mm_or_ps(_mm_and_ps(mmCompared, mmRight), _mm_andnot_ps(mmCompared, mmOne));
         _mm_store_si128(reinterpret_cast<__m128i*>(index), mmIndices);
 
-        auto mmRight = _mm_sub_ps(mmFloatIndex, _mm_cvtepi32_ps(mmIndices));
-        auto mmLeft = _mm_sub_ps(_mm_set_ps1(1.0f), mmRight);
+        auto mmLeft = _mm_sub_ps(mmOne, mmRight);
         _mm_store_ps(leftCoeff, mmLeft);
         _mm_store_ps(rightCoeff, mmRight);
 
@@ -450,6 +589,251 @@ float sfz::saturatingSFZIndex<float, true>(absl::Span<const float> jumps,
     return floatIndex;
 }
 
+template <>
+uint64_t sfz::fixedPointIndex<float, true>(absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs, absl::Span<int> indices, uint64_t position, uint64_t step) noexcept
+{
+    ASSERT(indices.size() == leftCoeffs.size());
+    ASSERT(indices.size() == rightCoeffs.size());
+    auto* index = indices.begin();
+    auto* leftCoeff = leftCoeffs.begin();
+    auto* rightCoeff = rightCoeffs.begin();
+    const auto size = min(indices.size(), leftCoeffs.size(), rightCoeffs.size());
+    auto* sentinel = index + size;
+    auto* lastVector = index + (size & ~TypeAlignmentMask);
+
+    if (index < lastVector) {
+        // Each register holds the 64 bit positions of 2 consecutive frames
+        auto mmPositions01 = _mm_set_epi64x(static_cast<int64_t>(position + 2 * step), static_cast<int64_t>(position + step));
+        auto mmPositions23 = _mm_set_epi64x(static_cast<int64_t>(position + 4 * step), static_cast<int64_t>(position + 3 * step));
+        const auto mmStep = _mm_set1_epi64x(static_cast<int64_t>(TypeAlignment * step));
+        const auto mmFraction = _mm_set_ps1(fixedPointFraction);
+        const auto mmOne = _mm_set_ps1(1.0f);
+        while (index < lastVector) {
+            // Gather the upper and lower halves of the 4 positions
+            const auto mmUpper = _mm_castps_si128(_mm_shuffle_ps(
+                _mm_castsi128_ps(mmPositions01), _mm_castsi128_ps(mmPositions23), _MM_SHUFFLE(3, 1, 3, 1)));
+            const auto mmLower = _mm_castps_si128(_mm_shuffle_ps(
+                _mm_castsi128_ps(mmPositions01), _mm_castsi128_ps(mmPositions23), _MM_SHUFFLE(2, 0, 2, 0)));
+            const auto mmRight = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(mmLower, 8)), mmFraction);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(index), mmUpper);
+            _mm_storeu_ps(rightCoeff, mmRight);
+            _mm_storeu_ps(leftCoeff, _mm_sub_ps(mmOne, mmRight));
+            mmPositions01 = _mm_add_epi64(mmPositions01, mmStep);
+            mmPositions23 = _mm_add_epi64(mmPositions23, mmStep);
+            index += TypeAlignment;
+            leftCoeff += TypeAlignment;
+            rightCoeff += TypeAlignment;
+        }
+        position += static_cast<uint64_t>(size & ~TypeAlignmentMask) * step;
+    }
+
+    while (index < sentinel) {
+        position += step;
+        snippetFixedPointIndex<float>(position, leftCoeff, rightCoeff, index);
+    }
+    return position;
+}
+
+template <>
+void sfz::linearInterpolation<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> output) noexcept
+{
+    ASSERT(leftCoeffs.size() == indices.size());
+    ASSERT(rightCoeffs.size() == indices.size());
+    ASSERT(output.size() >= indices.size());
+    auto* index = indices.begin();
+    auto* leftCoeff = leftCoeffs.begin();
+    auto* rightCoeff = rightCoeffs.begin();
+    auto* out = output.begin();
+    const auto size = min(indices.size(), leftCoeffs.size(), rightCoeffs.size(), output.size());
+    auto* sentinel = index + size;
+    const auto* data = source.data();
+
+#if defined(__AVX2__)
+    auto* lastVector = index + (size & ~size_t { 7 });
+    while (index < lastVector) {
+        const auto mmIndices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index));
+        const auto mmLeft = _mm256_i32gather_ps(data, mmIndices, sizeof(float));
+        const auto mmRight = _mm256_i32gather_ps(data + 1, mmIndices, sizeof(float));
+        const auto mmOut = _mm256_add_ps(
+            _mm256_mul_ps(mmLeft, _mm256_loadu_ps(leftCoeff)),
+            _mm256_mul_ps(mmRight, _mm256_loadu_ps(rightCoeff)));
+        _mm256_storeu_ps(out, mmOut);
+        index += 8;
+        leftCoeff += 8;
+        rightCoeff += 8;
+        out += 8;
+    }
+#else
+    auto* lastVector = index + (size & ~TypeAlignmentMask);
+    while (index < lastVector) {
+        const auto mmLeft = gatherSSE(data, index);
+        const auto mmRight = gatherSSE(data + 1, index);
+        const auto mmOut = _mm_add_ps(
+            _mm_mul_ps(mmLeft, _mm_loadu_ps(leftCoeff)),
+            _mm_mul_ps(mmRight, _mm_loadu_ps(rightCoeff)));
+        _mm_storeu_ps(out, mmOut);
+        index += TypeAlignment;
+        leftCoeff += TypeAlignment;
+        rightCoeff += TypeAlignment;
+        out += TypeAlignment;
+    }
+#endif
+
+    while (index < sentinel)
+        snippetLinearInterpolation<float>(data, index, leftCoeff, rightCoeff, out);
+}
+
+template <>
+void sfz::linearInterpolation<float, true>(absl::Span<const float> sourceLeft, absl::Span<const float> sourceRight, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
+{
+    ASSERT(sourceLeft.size() == sourceRight.size());
+    ASSERT(leftCoeffs.size() == indices.size());
+    ASSERT(rightCoeffs.size() == indices.size());
+    ASSERT(outputLeft.size() >= indices.size());
+    ASSERT(outputRight.size() >= indices.size());
+    auto* index = indices.begin();
+    auto* leftCoeff = leftCoeffs.begin();
+    auto* rightCoeff = rightCoeffs.begin();
+    auto* outLeft = outputLeft.begin();
+    auto* outRight = outputRight.begin();
+    const auto size = min(min(indices.size(), leftCoeffs.size(), rightCoeffs.size()), outputLeft.size(), outputRight.size());
+    auto* sentinel = index + size;
+    const auto* dataLeft = sourceLeft.data();
+    const auto* dataRight = sourceRight.data();
+
+#if defined(__AVX2__)
+    auto* lastVector = index + (size & ~size_t { 7 });
+    while (index < lastVector) {
+        const auto mmIndices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index));
+        const auto mmLeftCoeff = _mm256_loadu_ps(leftCoeff);
+        const auto mmRightCoeff = _mm256_loadu_ps(rightCoeff);
+        const auto mmOutLeft = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_i32gather_ps(dataLeft, mmIndices, sizeof(float)), mmLeftCoeff),
+            _mm256_mul_ps(_mm256_i32gather_ps(dataLeft + 1, mmIndices, sizeof(float)), mmRightCoeff));
+        const auto mmOutRight = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_i32gather_ps(dataRight, mmIndices, sizeof(float)), mmLeftCoeff),
+            _mm256_mul_ps(_mm256_i32gather_ps(dataRight + 1, mmIndices, sizeof(float)), mmRightCoeff));
+        _mm256_storeu_ps(outLeft, mmOutLeft);
+        _mm256_storeu_ps(outRight, mmOutRight);
+        index += 8;
+        leftCoeff += 8;
+        rightCoeff += 8;
+        outLeft += 8;
+        outRight += 8;
+    }
+#else
+    auto* lastVector = index + (size & ~TypeAlignmentMask);
+    while (index < lastVector) {
+        const auto mmLeftCoeff = _mm_loadu_ps(leftCoeff);
+        const auto mmRightCoeff = _mm_loadu_ps(rightCoeff);
+        const auto mmOutLeft = _mm_add_ps(
+            _mm_mul_ps(gatherSSE(dataLeft, index), mmLeftCoeff),
+            _mm_mul_ps(gatherSSE(dataLeft + 1, index), mmRightCoeff));
+        const auto mmOutRight = _mm_add_ps(
+            _mm_mul_ps(gatherSSE(dataRight, index), mmLeftCoeff),
+            _mm_mul_ps(gatherSSE(dataRight + 1, index), mmRightCoeff));
+        _mm_storeu_ps(outLeft, mmOutLeft);
+        _mm_storeu_ps(outRight, mmOutRight);
+        index += TypeAlignment;
+        leftCoeff += TypeAlignment;
+        rightCoeff += TypeAlignment;
+        outLeft += TypeAlignment;
+        outRight += TypeAlignment;
+    }
+#endif
+
+    while (index < sentinel)
+        snippetLinearInterpolation<float>(dataLeft, dataRight, index, leftCoeff, rightCoeff, outLeft, outRight);
+}
+
+template <>
+void sfz::wavetableBatch<float, true>(absl::Span<const float* const> tables, absl::Span<uint64_t> positions, absl::Span<const uint64_t> steps, absl::Span<const float* const> gains, absl::Span<float> powers, absl::Span<float> output, int tableSize) noexcept
+{
+    ASSERT(tables.size() == positions.size());
+    ASSERT(tables.size() == steps.size());
+    ASSERT(tables.size() == gains.size());
+    ASSERT(tables.size() == powers.size());
+    ASSERT(tableSize > 0 && (tableSize & (tableSize - 1)) == 0);
+    const auto wrapMask = (static_cast<uint64_t>(tableSize) << 32) - 1;
+    const auto numVoices = min(tables.size(), positions.size(), steps.size(), gains.size());
+    const auto numFrames = output.size();
+    const auto lastVectorVoice = numVoices & ~TypeAlignmentMask;
+    const auto lastVectorFrame = numFrames & ~TypeAlignmentMask;
+
+    const auto mmWrapMask = _mm_set1_epi64x(static_cast<int64_t>(wrapMask));
+    const auto mmFraction = _mm_set_ps1(fixedPointFraction);
+    const auto mmOne = _mm_set_ps1(1.0f);
+    alignas(ByteAlignment) std::array<int, TypeAlignment> indices;
+
+    size_t voice = 0;
+    for (; voice < lastVectorVoice; voice += TypeAlignment) {
+        // Each lane holds a voice; the 64 bit positions are split in 2 registers
+        const auto* positionData = reinterpret_cast<const __m128i*>(&positions[voice]);
+        const auto* stepData = reinterpret_cast<const __m128i*>(&steps[voice]);
+        auto mmPositions01 = _mm_loadu_si128(positionData);
+        auto mmPositions23 = _mm_loadu_si128(positionData + 1);
+        const auto mmSteps01 = _mm_loadu_si128(stepData);
+        const auto mmSteps23 = _mm_loadu_si128(stepData + 1);
+        const float* const* table = &tables[voice];
+        const float* const* gain = &gains[voice];
+
+        auto nextFrame = [&]() {
+            mmPositions01 = _mm_and_si128(_mm_add_epi64(mmPositions01, mmSteps01), mmWrapMask);
+            mmPositions23 = _mm_and_si128(_mm_add_epi64(mmPositions23, mmSteps23), mmWrapMask);
+            const auto mmUpper = _mm_castps_si128(_mm_shuffle_ps(
+                _mm_castsi128_ps(mmPositions01), _mm_castsi128_ps(mmPositions23), _MM_SHUFFLE(3, 1, 3, 1)));
+            const auto mmLower = _mm_castps_si128(_mm_shuffle_ps(
+                _mm_castsi128_ps(mmPositions01), _mm_castsi128_ps(mmPositions23), _MM_SHUFFLE(2, 0, 2, 0)));
+            const auto mmRight = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(mmLower, 8)), mmFraction);
+            _mm_store_si128(reinterpret_cast<__m128i*>(indices.data()), mmUpper);
+            const auto mmLeftValues = _mm_setr_ps(table[0][indices[0]], table[1][indices[1]], table[2][indices[2]], table[3][indices[3]]);
+            const auto mmRightValues = _mm_setr_ps(table[0][indices[0] + 1], table[1][indices[1] + 1], table[2][indices[2] + 1], table[3][indices[3] + 1]);
+            return _mm_add_ps(_mm_mul_ps(mmLeftValues, _mm_sub_ps(mmOne, mmRight)), _mm_mul_ps(mmRightValues, mmRight));
+        };
+
+        __m128 mmPowers[TypeAlignment];
+        for (auto& mmPower : mmPowers)
+            mmPower = _mm_setzero_ps();
+
+        size_t frame = 0;
+        for (; frame < lastVectorFrame; frame += TypeAlignment) {
+            // Compute 4 frames of the 4 voices, then transpose so that each register
+            // holds 4 consecutive frames of a voice and the gains load directly
+            __m128 mmValues[TypeAlignment];
+            for (auto& mmValue : mmValues)
+                mmValue = nextFrame();
+            _MM_TRANSPOSE4_PS(mmValues[0], mmValues[1], mmValues[2], mmValues[3]);
+
+            auto mmSum = _mm_setzero_ps();
+            for (unsigned lane = 0; lane < TypeAlignment; ++lane) {
+                const auto mmValue = _mm_mul_ps(mmValues[lane], _mm_loadu_ps(gain[lane] + frame));
+                mmPowers[lane] = _mm_add_ps(mmPowers[lane], _mm_mul_ps(mmValue, mmValue));
+                mmSum = _mm_add_ps(mmSum, mmValue);
+            }
+            _mm_storeu_ps(&output[frame], _mm_add_ps(_mm_loadu_ps(&output[frame]), mmSum));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&positions[voice]), mmPositions01);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&positions[voice + 2]), mmPositions23);
+        _MM_TRANSPOSE4_PS(mmPowers[0], mmPowers[1], mmPowers[2], mmPowers[3]);
+        const auto mmPowerSum = _mm_add_ps(_mm_add_ps(mmPowers[0], mmPowers[1]), _mm_add_ps(mmPowers[2], mmPowers[3]));
+        _mm_storeu_ps(&powers[voice], _mm_add_ps(_mm_loadu_ps(&powers[voice]), mmPowerSum));
+
+        for (unsigned lane = 0; lane < TypeAlignment; ++lane) {
+            for (size_t tail = frame; tail < numFrames; ++tail) {
+                const auto value = snippetWavetable<float>(table[lane], positions[voice + lane], steps[voice + lane], wrapMask) * gain[lane][tail];
+                output[tail] += value;
+                powers[voice + lane] += value * value;
+            }
+        }
+    }
+
+    if (voice < numVoices) {
+        wavetableBatch<float, false>(tables.subspan(voice), positions.subspan(voice), steps.subspan(voice),
+            gains.subspan(voice), powers.subspan(voice), output, tableSize);
+    }
+}
+
 template <>
 float sfz::linearRamp<float, true>(absl::Span<float> output, float value, float step) noexcept
 {
@@ -627,10 +1011,10 @@ void sfz::pan<float, true>(absl::Span<const float> panEnvelope, absl::Span<float
     while (pan < lastAligned) {
         auto mmPan = _mm_load_ps(pan);
         mmPan = _mm_add_ps(mmOne, mmPan);
-        mmPan = _mm_mul_ps(mmOne, mmPiFour);
+        mmPan = _mm_mul_ps(mmPan, mmPiFour);
         sincos_ps(mmPan, &mmSin, &mmCos);
         auto mmLeft = _mm_mul_ps(mmCos, _mm_load_ps(left));
-        auto mmRight = _mm_mul_ps(mmCos, _mm_load_ps(left));
+        auto mmRight = _mm_mul_ps(mmSin, _mm_load_ps(right));
         _mm_store_ps(left, mmLeft);
         _mm_store_ps(right, mmRight);
         left += TypeAlignment;
@@ -642,6 +1026,61 @@ void sfz::pan<float, true>(absl::Span<const float> panEnvelope, absl::Span<float
         snippetPan(pan, left, right);
 }
 
+template <>
+void sfz::panLaw<float, true>(absl::Span<const float> panEnvelope, absl::Span<float> cosOutput, absl::Span<float> sinOutput) noexcept
+{
+    ASSERT(cosOutput.size() >= panEnvelope.size());
+    ASSERT(sinOutput.size() >= panEnvelope.size());
+    auto* pan = panEnvelope.begin();
+    auto* cosOut = cosOutput.begin();
+    auto* sinOut = sinOutput.begin();
+    auto* sentinel = pan + min(panEnvelope.size(), cosOutput.size(), sinOutput.size());
+    const auto* lastAligned = prevAligned(sentinel);
+
+    while (unaligned(pan, cosOut, sinOut) && pan < lastAligned)
+        snippetPanLaw(pan, cosOut, sinOut);
+
+    // With t = pi/4 * pan in [-pi/4, pi/4] we have
+    //   cos(pi/4 (1 + pan)) = (cos(t) - sin(t)) / sqrt(2)
+    //   sin(pi/4 (1 + pan)) = (cos(t) + sin(t)) / sqrt(2)
+    // and the Cephes minimax polynomials for sin and cos are accurate to
+    // about 1 ulp over that range without any range reduction.
+    const auto mmOne = _mm_set_ps1(1.0f);
+    const auto mmMinusOne = _mm_set_ps1(-1.0f);
+    const auto mmHalf = _mm_set_ps1(0.5f);
+    const auto mmPiFour = _mm_set_ps1(piFour<float>);
+    const auto mmSqrtTwoInv = _mm_set_ps1(sqrtTwoInv<float>);
+    const auto mmSin1 = _mm_set_ps1(-1.6666654611e-1f);
+    const auto mmSin2 = _mm_set_ps1(8.3321608736e-3f);
+    const auto mmSin3 = _mm_set_ps1(-1.9515295891e-4f);
+    const auto mmCos1 = _mm_set_ps1(4.166664568298827e-2f);
+    const auto mmCos2 = _mm_set_ps1(-1.388731625493765e-3f);
+    const auto mmCos3 = _mm_set_ps1(2.443315711809948e-5f);
+    while (pan < lastAligned) {
+        auto mmPan = _mm_min_ps(_mm_max_ps(_mm_load_ps(pan), mmMinusOne), mmOne);
+        const auto t = _mm_mul_ps(mmPan, mmPiFour);
+        const auto t2 = _mm_mul_ps(t, t);
+
+        auto mmSin = _mm_add_ps(_mm_mul_ps(mmSin3, t2), mmSin2);
+        mmSin = _mm_add_ps(_mm_mul_ps(mmSin, t2), mmSin1);
+        mmSin = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(mmSin, t2), t), t);
+
+        auto mmCos = _mm_add_ps(_mm_mul_ps(mmCos3, t2), mmCos2);
+        mmCos = _mm_add_ps(_mm_mul_ps(mmCos, t2), mmCos1);
+        mmCos = _mm_mul_ps(_mm_mul_ps(mmCos, t2), t2);
+        mmCos = _mm_add_ps(_mm_sub_ps(mmOne, _mm_mul_ps(mmHalf, t2)), mmCos);
+
+        _mm_store_ps(cosOut, _mm_mul_ps(mmSqrtTwoInv, _mm_sub_ps(mmCos, mmSin)));
+        _mm_store_ps(sinOut, _mm_mul_ps(mmSqrtTwoInv, _mm_add_ps(mmCos, mmSin)));
+        pan += TypeAlignment;
+        cosOut += TypeAlignment;
+        sinOut += TypeAlignment;
+    }
+
+    while (pan < sentinel)
+        snippetPanLaw(pan, cosOut, sinOut);
+}
+
 template <>
 float sfz::mean<float, true>(absl::Span<const float> vector) noexcept
 {
@@ -779,6 +1218,104 @@ void sfz::sfzInterpolationCast<float, true>(absl::Span<const float> floatJumps,
         snippetSFZInterpolationCast(floatJump, jump, leftCoeff, rightCoeff);
 }
 
+template <>
+void sfz::hermiteInterpolation<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept
+{
+    ASSERT(coeffs.size() == indices.size());
+    ASSERT(output.size() >= indices.size());
+    auto* index = indices.begin();
+    auto* coeff = coeffs.begin();
+    auto* out = output.begin();
+    const auto size = min(indices.size(), coeffs.size(), output.size());
+    auto* sentinel = index + size;
+    const auto* data = source.data();
+    const auto sourceSize = static_cast<int>(source.size());
+    const auto mmHalf = _mm_set_ps1(0.5f);
+
+    auto* lastVector = index + (size & ~TypeAlignmentMask);
+    while (index < lastVector) {
+        const auto extremes = std::minmax({ index[0], index[1], index[2], index[3] });
+        if (extremes.first < 1 || extremes.second + 2 >= sourceSize) {
+            for (unsigned i = 0; i < TypeAlignment; ++i)
+                snippetHermiteInterpolation<float>(data, sourceSize, index, coeff, out);
+            continue;
+        }
+
+        // Each frame reads 4 contiguous source values, so load them as rows
+        // and transpose to get one register per tap
+        auto mmXm1 = _mm_loadu_ps(data + index[0] - 1);
+        auto mmX0 = _mm_loadu_ps(data + index[1] - 1);
+        auto mmX1 = _mm_loadu_ps(data + index[2] - 1);
+        auto mmX2 = _mm_loadu_ps(data + index[3] - 1);
+        _MM_TRANSPOSE4_PS(mmXm1, mmX0, mmX1, mmX2);
+
+        const auto mmT = _mm_loadu_ps(coeff);
+        const auto mmC = _mm_mul_ps(_mm_sub_ps(mmX1, mmXm1), mmHalf);
+        const auto mmV = _mm_sub_ps(mmX0, mmX1);
+        const auto mmW = _mm_add_ps(mmC, mmV);
+        const auto mmA = _mm_add_ps(_mm_add_ps(mmW, mmV), _mm_mul_ps(_mm_sub_ps(mmX2, mmX0), mmHalf));
+        const auto mmBNeg = _mm_add_ps(mmW, mmA);
+        auto mmOut = _mm_sub_ps(_mm_mul_ps(mmA, mmT), mmBNeg);
+        mmOut = _mm_add_ps(_mm_mul_ps(mmOut, mmT), mmC);
+        mmOut = _mm_add_ps(_mm_mul_ps(mmOut, mmT), mmX0);
+        _mm_storeu_ps(out, mmOut);
+        index += TypeAlignment;
+        coeff += TypeAlignment;
+        out += TypeAlignment;
+    }
+
+    while (index < sentinel)
+        snippetHermiteInterpolation<float>(data, sourceSize, index, coeff, out);
+}
+
+template <int Taps>
+void sincInterpolationSSE(absl::Span<const float> source, const int* index, const int* sentinel, const float* coeff, float* out) noexcept
+{
+    using Table = sfz::WindowedSincTable<float, Taps>;
+    const auto& table = Table::get();
+    const auto* data = source.data();
+    const auto sourceSize = static_cast<int>(source.size());
+
+    // The kernel is vectorized along the taps, one output frame at a time
+    while (index < sentinel) {
+        const int first = *index - Taps / 2 + 1;
+        if (first < 0 || first + Taps > sourceSize) {
+            sfz::snippetSincInterpolation<float, Taps>(data, sourceSize, table, index, coeff, out);
+            continue;
+        }
+
+        const float position = *coeff * Table::phases;
+        const int phase = min(static_cast<int>(position), Table::phases - 1);
+        const auto mmMix = _mm_set_ps1(position - static_cast<float>(phase));
+        const float* row0 = table.row(phase);
+        const float* row1 = table.row(phase + 1);
+        auto mmSum = _mm_setzero_ps();
+        for (int tap = 0; tap < Taps; tap += TypeAlignment) {
+            const auto mmRow0 = _mm_load_ps(row0 + tap);
+            const auto mmKernel = _mm_add_ps(mmRow0, _mm_mul_ps(mmMix, _mm_sub_ps(_mm_load_ps(row1 + tap), mmRow0)));
+            mmSum = _mm_add_ps(mmSum, _mm_mul_ps(mmKernel, _mm_loadu_ps(data + first + tap)));
+        }
+        mmSum = _mm_add_ps(mmSum, _mm_movehl_ps(mmSum, mmSum));
+        mmSum = _mm_add_ss(mmSum, _mm_shuffle_ps(mmSum, mmSum, _MM_SHUFFLE(1, 1, 1, 1)));
+        *out++ = _mm_cvtss_f32(mmSum);
+        index++;
+        coeff++;
+    }
+}
+
+template <>
+void sfz::sincInterpolation<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output, int taps) noexcept
+{
+    ASSERT(taps == 8 || taps == 16);
+    ASSERT(coeffs.size() == indices.size());
+    ASSERT(output.size() >= indices.size());
+    const auto size = min(indices.size(), coeffs.size(), output.size());
+    if (taps > 8)
+        sincInterpolationSSE<16>(source, indices.begin(), indices.begin() + size, coeffs.begin(), output.begin());
+    else
+        sincInterpolationSSE<8>(source, indices.begin(), indices.begin() + size, coeffs.begin(), output.begin());
+}
+
 template <>
 void sfz::diff<float, true>(absl::Span<const float> input, absl::Span<float> output) noexcept
 {
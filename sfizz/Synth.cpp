@@ -28,7 +28,9 @@
 #include "MidiState.h"
 #include "ScopedFTZ.h"
 #include "StringViewHelpers.h"
+#include "Wavetables.h"
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include <algorithm>
 #include <chrono>
 #include <iostream>
@@ -37,9 +39,71 @@ using namespace std::literals;
 
 sfz::Synth::Synth()
 {
-    for (int i = 0; i < config::numVoices; ++i)
+    pendingEvents.reserve(2 * eventQueue.capacity());
+    allocateVoices(config::numVoices);
+}
+
+void sfz::Synth::allocateVoices(int numVoices)
+{
+    activeVoices.clear();
+    freeVoices.clear();
+    stealCandidates.clear();
+    voices.clear();
+
+    // Everything the audio thread touches is sized here so that it never allocates
+    for (int i = 0; i < numVoices; ++i) {
         voices.push_back(std::make_unique<Voice>(midiState));
-    voiceViewArray.reserve(config::numVoices);
+        voices.back()->setSampleRate(sampleRate);
+        voices.back()->setSampleQuality(sampleQuality);
+        voices.back()->setSilenceGate(silenceThreshold, silenceQuanta);
+        voices.back()->setStream(filePool.getStream(i));
+    }
+    activeVoices.reserve(numVoices);
+    freeVoices.reserve(numVoices);
+    for (auto voice = voices.rbegin(); voice < voices.rend(); ++voice)
+        freeVoices.push_back(voice->get());
+    stealCandidates.reserve(numVoices);
+    renderedVoices.reserve(numVoices);
+    batchedVoices.reserve(numVoices);
+    renderPool.setNumVoices(numVoices);
+    generatorBatch.setNumVoices(numVoices);
+    allocateScratchBuffers();
+}
+
+void sfz::Synth::allocateScratchBuffers()
+{
+    // The voices only ever render a quantum; round it up so that every scratch buffer stays aligned
+    constexpr size_t alignment { SIMDConfig::defaultAlignment / sizeof(float) };
+    const auto quantum = std::min(samplesPerBlock, config::renderQuantum);
+    const auto blockSize = (static_cast<size_t>(quantum) + alignment - 1) / alignment * alignment;
+    const auto voiceScratchSize = Voice::numScratchBuffers * blockSize;
+    scratchArena.resize(voices.size() * voiceScratchSize);
+    indexArena.resize(voices.size() * blockSize);
+
+    auto scratch = absl::MakeSpan(scratchArena);
+    auto indices = absl::MakeSpan(indexArena);
+    for (size_t i = 0; i < voices.size(); ++i) {
+        voices[i]->setSamplesPerBlock(quantum);
+        voices[i]->setScratchBuffers(scratch.subspan(i * voiceScratchSize, voiceScratchSize), indices.subspan(i * blockSize, blockSize));
+    }
+}
+
+void sfz::Synth::setNumVoices(int numVoices) noexcept
+{
+    ASSERT(numVoices > 0);
+    AtomicDisabler callbackDisabler { canEnterCallback };
+    while (inCallback) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    // The pending loads point to the current voices, so drop them first
+    filePool.setNumVoices(std::max(numVoices, 1));
+    allocateVoices(std::max(numVoices, 1));
+}
+
+int sfz::Synth::getNumVoices() const noexcept
+{
+    return static_cast<int>(voices.size());
 }
 
 void sfz::Synth::callback(absl::string_view header, const std::vector<Opcode>& members)
@@ -102,6 +166,7 @@ void sfz::Synth::buildRegion(const std::vector<Opcode>& regionOpcodes)
     parseOpcodes(masterOpcodes);
     parseOpcodes(groupOpcodes);
     parseOpcodes(regionOpcodes);
+    lastRegion->compileModulations();
 
     regions.push_back(std::move(lastRegion));
 }
@@ -115,6 +180,17 @@ void sfz::Synth::clear()
     
     for (auto &voice: voices)
         voice->reset();
+    activeVoices.clear();
+    freeVoices.clear();
+    for (auto voice = voices.rbegin(); voice < voices.rend(); ++voice)
+        freeVoices.push_back(voice->get());
+    stealCandidates.clear();
+    // The events sent so far were meant for the previous instrument
+    MidiEvent event;
+    while (eventQueue.tryPop(event)) {
+        // Pop the queue
+    }
+    pendingEvents.clear();
     for (auto& list: noteActivationLists)
         list.clear();
     for (auto& list: ccActivationLists)
@@ -214,23 +290,42 @@ bool sfz::Synth::loadSfzFile(const fs::path& filename)
 
     filePool.setRootDirectory(this->rootDirectory);
 
+    // Read each sample once, with the largest offset its regions play it from
+    absl::flat_hash_map<absl::string_view, size_t> sampleIndices;
+    std::vector<std::pair<absl::string_view, uint32_t>> samples;
+    for (auto& region : regions) {
+        if (region->isGenerator())
+            continue;
+
+        const auto offset = region->offset + region->offsetRandom;
+        const auto inserted = sampleIndices.try_emplace(region->sample, samples.size());
+        if (inserted.second)
+            samples.emplace_back(region->sample, offset);
+        else
+            samples[inserted.first->second].second = std::max(samples[inserted.first->second].second, offset);
+    }
+    const auto fileInformation = filePool.scanFiles(samples, numLoadingThreads);
+
     auto lastRegion = regions.end() - 1;
     auto currentRegion = regions.begin();
     while (currentRegion <= lastRegion) {
         auto region = currentRegion->get();
 
         if (!region->isGenerator()) {
-            auto fileInformation = filePool.getFileInformation(region->sample, region->offset + region->offsetRandom);
-            if (!fileInformation) {
+            const auto& information = fileInformation[sampleIndices[region->sample]];
+            if (!information) {
                 DBG("Removing the region with sample " << region->sample);
                 std::iter_swap(currentRegion, lastRegion);
                 lastRegion--;
                 continue;
             }
-            region->sampleEnd = std::min(region->sampleEnd, fileInformation->end);
-            region->loopRange.shrinkIfSmaller(fileInformation->loopBegin, fileInformation->loopEnd);
-            region->preloadedData = fileInformation->preloadedData;
-            region->sampleRate = fileInformation->sampleRate;
+            region->sampleEnd = std::min(region->sampleEnd, information->end);
+            region->loopRange.shrinkIfSmaller(information->loopBegin, information->loopEnd);
+            region->preloadedData = information->preloadedData;
+            region->sampleRate = information->sampleRate;
+        } else {
+            // Build the shared wavetables now rather than on the audio thread
+            WavetableBank::get();
         }
 
         for (auto note = 0; note < 128; note++) {
@@ -268,38 +363,66 @@ bool sfz::Synth::loadSfzFile(const fs::path& filename)
 
 sfz::Voice* sfz::Synth::findFreeVoice() noexcept
 {
-    auto freeVoice = absl::c_find_if(voices, [](const auto& voice) { return voice->isFree(); });
-    if (freeVoice != voices.end())
-        return freeVoice->get();
+    if (freeVoices.empty()) {
+        DBG("No free voice, trying to steal");
+        auto voice = stealVoice();
+        if (voice == nullptr)
+            DBG("Voices are overloaded, can't start a new note");
+        return voice;
+    }
 
-    // Find voices that can be stolen
-    DBG("No free voice, trying to steal");
-    voiceViewArray.clear();
-    for (auto& voice : voices)
-        if (voice->canBeStolen())
-            voiceViewArray.push_back(voice.get());
-    absl::c_sort(voices, [](const auto& lhs, const auto& rhs) { return lhs->getSourcePosition() > rhs->getSourcePosition(); });
-
-    for (auto* voice : voiceViewArray) {
-        DBG("Average voice power: " << voice->getMeanSquaredAverage());
-        if (voice->getMeanSquaredAverage() < config::voiceStealingThreshold) {
-            DBG("Stealing voice...");
-            voice->reset();
-            return voice;
+    // The caller is going to start this voice right away
+    auto voice = freeVoices.back();
+    freeVoices.pop_back();
+    activeVoices.push_back(voice);
+    stealCandidates.push_back({ voice, voiceStartCounter++ });
+    return voice;
+}
+
+sfz::Voice* sfz::Synth::stealVoice() noexcept
+{
+    if (stealCandidates.empty())
+        return {};
+
+    // Released voices are stolen first, the quietest one first, then the oldest playing voices
+    auto best = stealCandidates.begin();
+    auto bestPower = best->voice->getMeanSquaredAverage();
+    for (auto candidate = stealCandidates.begin() + 1; candidate < stealCandidates.end(); ++candidate) {
+        const auto released = candidate->voice->canBeStolen();
+        if (released != best->voice->canBeStolen()) {
+            if (released) {
+                best = candidate;
+                bestPower = candidate->voice->getMeanSquaredAverage();
+            }
+            continue;
+        }
+
+        const auto power = candidate->voice->getMeanSquaredAverage();
+        if (released && power != bestPower) {
+            if (power < bestPower) {
+                best = candidate;
+                bestPower = power;
+            }
+            continue;
+        }
+
+        if (candidate->startOrder < best->startOrder) {
+            best = candidate;
+            bestPower = power;
         }
     }
 
-    DBG("Voices are overloaded, can't start a new note");
-    return {};
+    // The stolen voice stays in the active list and restarts as the youngest voice
+    auto* voice = best->voice;
+    best->startOrder = voiceStartCounter++;
+    DBG("Stealing voice with average power " << bestPower);
+    voice->reset();
+    return voice;
 }
 
-void sfz::Synth::getNumActiveVoices() const noexcept
+int sfz::Synth::getNumActiveVoices() const noexcept
 {
-    auto activeVoices { 0 };
-    for (const auto& voice : voices) {
-        if (!voice->isFree())
-            activeVoices++;
-    }
+    return static_cast<int>(activeVoices.size());
 }
 
 void sfz::Synth::garbageCollect() noexcept
@@ -317,9 +440,124 @@ void sfz::Synth::setSamplesPerBlock(int samplesPerBlock) noexcept
     }
 
     this->samplesPerBlock = samplesPerBlock;
-    this->tempBuffer.resize(samplesPerBlock);
+    allocateScratchBuffers();
+    renderPool.setSamplesPerBlock(std::min(samplesPerBlock, config::renderQuantum));
+    generatorBatch.setSamplesPerBlock(std::min(samplesPerBlock, config::renderQuantum));
+    if (filePool.setStreamingLookahead(streamingBlocks * samplesPerBlock))
+        restartStreams();
+}
+
+void sfz::Synth::setNumThreads(int numThreads) noexcept
+{
+    AtomicDisabler callbackDisabler { canEnterCallback };
+    while (inCallback) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    renderPool.setNumThreads(numThreads);
+}
+
+int sfz::Synth::getNumThreads() const noexcept
+{
+    return renderPool.getNumThreads();
+}
+
+void sfz::Synth::setDeterministicRendering(bool deterministic) noexcept
+{
+    AtomicDisabler callbackDisabler { canEnterCallback };
+    while (inCallback) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    renderPool.setDeterministic(deterministic);
+}
+
+void sfz::Synth::setSampleQuality(int quality) noexcept
+{
+    AtomicDisabler callbackDisabler { canEnterCallback };
+    while (inCallback) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    sampleQuality = Default::sampleQualityRange.clamp(quality);
     for (auto& voice : voices)
-        voice->setSamplesPerBlock(samplesPerBlock);
+        voice->setSampleQuality(sampleQuality);
+}
+
+int sfz::Synth::getSampleQuality() const noexcept
+{
+    return sampleQuality;
+}
+
+void sfz::Synth::setSilenceGate(float thresholddB, int numQuanta) noexcept
+{
+    AtomicDisabler callbackDisabler { canEnterCallback };
+    while (inCallback) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    silenceThreshold = thresholddB;
+    silenceQuanta = std::max(numQuanta, 0);
+    for (auto& voice : voices)
+        voice->setSilenceGate(silenceThreshold, silenceQuanta);
+}
+
+int sfz::Synth::getNumSilentVoicesFreed() const noexcept
+{
+    return numSilentVoicesFreed.load(std::memory_order_relaxed);
+}
+
+void sfz::Synth::setStreamingLookahead(int numBlocks) noexcept
+{
+    ASSERT(numBlocks > 0);
+    AtomicDisabler callbackDisabler { canEnterCallback };
+    while (inCallback) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    streamingBlocks = std::max(numBlocks, 1);
+    if (filePool.setStreamingLookahead(streamingBlocks * samplesPerBlock))
+        restartStreams();
+}
+
+int sfz::Synth::getStreamingLookahead() const noexcept
+{
+    return streamingBlocks;
+}
+
+void sfz::Synth::setStreamingReadRate(double bytesPerSecond) noexcept
+{
+    filePool.setStreamingReadRate(bytesPerSecond);
+}
+
+int sfz::Synth::getNumStreamUnderruns() const noexcept
+{
+    return filePool.getNumStreamUnderruns();
+}
+
+void sfz::Synth::setNumLoadingThreads(int numThreads) noexcept
+{
+    numLoadingThreads = std::max(numThreads, 1);
+}
+
+int sfz::Synth::getNumLoadingThreads() const noexcept
+{
+    return numLoadingThreads;
+}
+
+void sfz::Synth::setMemoryMappedStreaming(bool enabled) noexcept
+{
+    filePool.setMemoryMapping(enabled);
+}
+
+void sfz::Synth::setFileCacheSize(size_t numBytes) noexcept
+{
+    filePool.setFileCacheSize(numBytes);
+}
+
+sfz::FilePool::CacheStatistics sfz::Synth::getFileCacheStatistics() const noexcept
+{
+    return filePool.getFileCacheStatistics();
 }
 
 void sfz::Synth::setSampleRate(float sampleRate) noexcept
@@ -344,10 +582,63 @@ void sfz::Synth::renderBlock(AudioSpan<float> buffer) noexcept
 
     AtomicGuard callbackGuard { inCallback };
 
-    auto tempSpan = AudioSpan<float>(tempBuffer).first(buffer.getNumFrames());
-    for (auto& voice : voices) {
-        voice->renderBlock(tempSpan);
-        buffer.add(tempSpan);
+    // The delays count from the start of the block, so the events sent while
+    // rendering wait for the next block
+    drainEvents();
+
+    // Render in quanta so that the voices work on small buffers that stay in cache.
+    // The events are due at the start of the quantum containing them; their delay
+    // still places them exactly within the quantum.
+    const auto numFrames = static_cast<int>(buffer.getNumFrames());
+    for (int offset = 0; offset < numFrames; offset += config::renderQuantum) {
+        const auto quantum = std::min(config::renderQuantum, numFrames - offset);
+        processEvents(quantum);
+
+        // The periodic generators are rendered side by side in a single pass on the
+        // calling thread, and the pool takes care of the other voices
+        renderedVoices.clear();
+        batchedVoices.clear();
+        for (auto* voice : activeVoices) {
+            if (voice->isBatchable())
+                batchedVoices.push_back(voice);
+            else
+                renderedVoices.push_back(voice);
+        }
+
+        auto quantumSpan = buffer.subspan(offset, quantum);
+        renderPool.renderVoices(renderedVoices, quantumSpan);
+        generatorBatch.renderVoices(batchedVoices, quantumSpan);
+        retireFinishedVoices();
+    }
+}
+
+void sfz::Synth::retireFinishedVoices() noexcept
+{
+    bool voicesFinished { false };
+    for (auto voice = activeVoices.begin(); voice < activeVoices.end();) {
+        if ((*voice)->isFree()) {
+            if ((*voice)->wasRetiredBySilence())
+                numSilentVoicesFreed.fetch_add(1, std::memory_order_relaxed);
+            freeVoices.push_back(*voice);
+            std::iter_swap(voice, activeVoices.end() - 1);
+            activeVoices.pop_back();
+            voicesFinished = true;
+        } else {
+            voice++;
+        }
+    }
+
+    if (voicesFinished) {
+        auto finished = std::remove_if(stealCandidates.begin(), stealCandidates.end(),
+            [](const StealCandidate& candidate) { return candidate.voice->isFree(); });
+        stealCandidates.erase(finished, stealCandidates.end());
+    }
+}
+
+void sfz::Synth::pushEvent(const MidiEvent& event) noexcept
+{
+    if (!eventQueue.tryPush(event)) {
+        DBG("Event queue full, dropping an event");
     }
 }
 
@@ -355,21 +646,133 @@ void sfz::Synth::noteOn(int delay, int channel, int noteNumber, uint8_t velocity
 {
     ASSERT(noteNumber < 128);
     ASSERT(noteNumber >= 0);
+    pushEvent({ MidiEvent::Type::NoteOn, std::max(delay, 0), channel, noteNumber, velocity, 0.0f });
+}
 
-    midiState.noteOn(noteNumber, velocity);
+void sfz::Synth::noteOff(int delay, int channel, int noteNumber, uint8_t velocity) noexcept
+{
+    ASSERT(noteNumber < 128);
+    ASSERT(noteNumber >= 0);
+    pushEvent({ MidiEvent::Type::NoteOff, std::max(delay, 0), channel, noteNumber, velocity, 0.0f });
+}
 
-    if (!canEnterCallback)
+void sfz::Synth::cc(int delay, int channel, int ccNumber, uint8_t ccValue) noexcept
+{
+    ASSERT(ccNumber < 128);
+    ASSERT(ccNumber >= 0);
+    pushEvent({ MidiEvent::Type::CC, std::max(delay, 0), channel, ccNumber, ccValue, 0.0f });
+}
+
+void sfz::Synth::pitchWheel(int delay, int channel, int pitch) noexcept
+{
+    pushEvent({ MidiEvent::Type::PitchWheel, std::max(delay, 0), channel, 0, pitch, 0.0f });
+}
+
+void sfz::Synth::aftertouch(int delay, int channel, uint8_t aftertouch) noexcept
+{
+    pushEvent({ MidiEvent::Type::Aftertouch, std::max(delay, 0), channel, 0, aftertouch, 0.0f });
+}
+
+void sfz::Synth::tempo(int delay, float secondsPerQuarter) noexcept
+{
+    pushEvent({ MidiEvent::Type::Tempo, std::max(delay, 0), 0, 0, 0, secondsPerQuarter });
+}
+
+void sfz::Synth::drainEvents() noexcept
+{
+    // Insert the new events after the ones with the same delay, which keeps the
+    // order in which they were sent. The capacity is reserved so this never allocates.
+    MidiEvent newEvent;
+    while (pendingEvents.size() < pendingEvents.capacity() && eventQueue.tryPop(newEvent)) {
+        auto position = std::upper_bound(pendingEvents.begin(), pendingEvents.end(), newEvent.delay,
+            [](int delay, const MidiEvent& pending) { return delay < pending.delay; });
+        pendingEvents.insert(position, newEvent);
+    }
+}
+
+void sfz::Synth::processEvents(int numFrames) noexcept
+{
+    auto event = pendingEvents.begin();
+    for (; event < pendingEvents.end() && event->delay < numFrames; ++event) {
+        switch (event->type) {
+        case MidiEvent::Type::NoteOn:
+            handleNoteOn(event->delay, event->channel, event->number, static_cast<uint8_t>(event->value));
+            break;
+        case MidiEvent::Type::NoteOff:
+            handleNoteOff(event->delay, event->channel, event->number, static_cast<uint8_t>(event->value));
+            break;
+        case MidiEvent::Type::CC:
+            handleCC(event->delay, event->channel, event->number, static_cast<uint8_t>(event->value));
+            break;
+        case MidiEvent::Type::PitchWheel:
+            handlePitchWheel(event->delay, event->channel, event->value);
+            break;
+        case MidiEvent::Type::Aftertouch:
+            handleAftertouch(event->delay, event->channel, static_cast<uint8_t>(event->value));
+            break;
+        case MidiEvent::Type::Tempo:
+            handleTempo(event->delay, event->secondsPerQuarter);
+            break;
+        }
+    }
+
+    pendingEvents.erase(pendingEvents.begin(), event);
+    for (auto& pending : pendingEvents)
+        pending.delay -= numFrames;
+}
+
+void sfz::Synth::requestFileData(Voice* voice, Region* region) noexcept
+{
+    if (region->isGenerator() || region->canUsePreloadedData())
         return;
 
-    AtomicGuard callbackGuard { inCallback };
+    // Looping regions jump back into parts of the file that a stream would have
+    // dropped already, so they still load the whole file
+    const auto ticket = nextFileTicket();
+    if (region->shouldLoop() || region->preloadedData == nullptr) {
+        voice->expectFileData(ticket);
+        filePool.enqueueLoading(voice, &region->sample, region->trueSampleEnd(), ticket);
+        return;
+    }
+
+    voice->expectStream(ticket);
+    filePool.enqueueStreaming(voice->getStream(), *region, static_cast<int>(voice->getSourcePosition()), ticket);
+}
+
+void sfz::Synth::restartStreams() noexcept
+{
+    for (auto* voice : activeVoices) {
+        if (!voice->isStreaming())
+            continue;
+
+        const auto ticket = nextFileTicket();
+        voice->expectStream(ticket);
+        filePool.enqueueStreaming(voice->getStream(), *voice->getRegion(), static_cast<int>(voice->getSourcePosition()), ticket);
+    }
+}
+
+unsigned sfz::Synth::nextFileTicket() noexcept
+{
+    // Tickets of 0 stop the streams
+    if (fileTicket == 0)
+        fileTicket++;
+
+    return fileTicket++;
+}
+
+void sfz::Synth::handleNoteOn(int delay, int channel, int noteNumber, uint8_t velocity) noexcept
+{
+    midiState.noteOn(noteNumber, velocity);
 
     auto randValue = randNoteDistribution(Random::randomGenerator);
 
     for (auto& region : noteActivationLists[noteNumber]) {
         if (region->registerNoteOn(channel, noteNumber, velocity, randValue)) {
-            for (auto& voice : voices) {
+            // handleNoteOff() can start release voices, so the active list may grow while we iterate
+            for (size_t i = 0; i < activeVoices.size(); ++i) {
+                auto* voice = activeVoices[i];
                 if (voice->checkOffGroup(delay, region->group))
-                    noteOff(delay, voice->getTriggerChannel(), voice->getTriggerNumber(), 0);
+                    handleNoteOff(delay, voice->getTriggerChannel(), voice->getTriggerNumber(), 0);
             }
 
             auto voice = findFreeVoice();
@@ -377,30 +780,19 @@ void sfz::Synth::noteOn(int delay, int channel, int noteNumber, uint8_t velocity
                 continue;
 
             voice->startVoice(region, delay, channel, noteNumber, velocity, Voice::TriggerType::NoteOn);
-            if (!region->isGenerator()) {
-                voice->expectFileData(fileTicket);
-                filePool.enqueueLoading(voice, &region->sample, region->trueSampleEnd(), fileTicket++);
-            }
+            requestFileData(voice, region);
         }
     }
 }
 
-void sfz::Synth::noteOff(int delay, int channel, int noteNumber, uint8_t velocity [[maybe_unused]]) noexcept
+void sfz::Synth::handleNoteOff(int delay, int channel, int noteNumber, uint8_t velocity [[maybe_unused]]) noexcept
 {
-    ASSERT(noteNumber < 128);
-    ASSERT(noteNumber >= 0);
-
-    if (!canEnterCallback)
-        return;
-
-    AtomicGuard callbackGuard { inCallback };
-
     // FIXME: Some keyboards (e.g. Casio PX5S) can send a real note-off velocity. In this case, do we have a
     // way in sfz to specify that a release trigger should NOT use the note-on velocity?
     // auto replacedVelocity = (velocity == 0 ? sfz::getNoteVelocity(noteNumber) : velocity);
     auto replacedVelocity = midiState.getNoteVelocity(noteNumber);
     auto randValue = randNoteDistribution(Random::randomGenerator);
-    for (auto& voice : voices)
+    for (auto* voice : activeVoices)
         voice->registerNoteOff(delay, channel, noteNumber, replacedVelocity);
 
     for (auto& region : noteActivationLists[noteNumber]) {
@@ -410,25 +802,14 @@ void sfz::Synth::noteOff(int delay, int channel, int noteNumber, uint8_t velocit
                 continue;
 
             voice->startVoice(region, delay, channel, noteNumber, replacedVelocity, Voice::TriggerType::NoteOff);
-            if (!region->isGenerator()) {
-                voice->expectFileData(fileTicket);
-                filePool.enqueueLoading(voice, &region->sample, region->trueSampleEnd(), fileTicket++);
-            }
+            requestFileData(voice, region);
         }
     }
 }
 
-void sfz::Synth::cc(int delay, int channel, int ccNumber, uint8_t ccValue) noexcept
+void sfz::Synth::handleCC(int delay, int channel, int ccNumber, uint8_t ccValue) noexcept
 {
-    ASSERT(ccNumber < 128);
-    ASSERT(ccNumber >= 0);
-
-    if (!canEnterCallback)
-        return;
-
-    AtomicGuard callbackGuard { inCallback };
-
-    for (auto& voice : voices)
+    for (auto* voice : activeVoices)
         voice->registerCC(delay, channel, ccNumber, ccValue);
 
     midiState.cc[ccNumber] = ccValue;
@@ -440,14 +821,35 @@ void sfz::Synth::cc(int delay, int channel, int ccNumber, uint8_t ccValue) noexc
                 continue;
 
             voice->startVoice(region, delay, channel, ccNumber, ccValue, Voice::TriggerType::CC);
-            if (!region->isGenerator()) {
-                voice->expectFileData(fileTicket);
-                filePool.enqueueLoading(voice, &region->sample, region->trueSampleEnd(), fileTicket++);
-            }
+            requestFileData(voice, region);
         }
     }
 }
 
+void sfz::Synth::handlePitchWheel(int delay, int channel, int pitch) noexcept
+{
+    for (auto& region : regions)
+        region->registerPitchWheel(channel, pitch);
+    for (auto* voice : activeVoices)
+        voice->registerPitchWheel(delay, channel, pitch);
+}
+
+void sfz::Synth::handleAftertouch(int delay, int channel, uint8_t aftertouch) noexcept
+{
+    for (auto& region : regions)
+        region->registerAftertouch(channel, aftertouch);
+    for (auto* voice : activeVoices)
+        voice->registerAftertouch(delay, channel, aftertouch);
+}
+
+void sfz::Synth::handleTempo(int delay, float secondsPerQuarter) noexcept
+{
+    for (auto& region : regions)
+        region->registerTempo(secondsPerQuarter);
+    for (auto* voice : activeVoices)
+        voice->registerTempo(delay, secondsPerQuarter);
+}
+
 int sfz::Synth::getNumRegions() const noexcept
 {
     return static_cast<int>(regions.size());
@@ -468,6 +870,11 @@ const sfz::Region* sfz::Synth::getRegionView(int idx) const noexcept
 {
     return (size_t)idx < regions.size() ? regions[idx].get() : nullptr;
 }
+
+const sfz::Voice* sfz::Synth::getVoiceView(int idx) const noexcept
+{
+    return (size_t)idx < voices.size() ? voices[idx].get() : nullptr;
+}
 std::set<absl::string_view> sfz::Synth::getUnknownOpcodes() const noexcept
 {
     return unknownOpcodes;
@@ -27,12 +27,18 @@
 #include "Region.h"
 #include "LeakDetector.h"
 #include "MidiState.h"
+#include "RenderThreadPool.h"
+#include "GeneratorBatch.h"
 #include "AudioSpan.h"
+#include "Buffer.h"
+#include "EventQueue.h"
 #include "absl/types/span.h"
 #include <absl/types/optional.h>
+#include <algorithm>
 #include <random>
 #include <set>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 namespace sfz {
@@ -46,12 +52,95 @@ public:
     int getNumMasters() const noexcept;
     int getNumCurves() const noexcept;
     const Region* getRegionView(int idx) const noexcept;
+    const Voice* getVoiceView(int idx) const noexcept;
     std::set<absl::string_view> getUnknownOpcodes() const noexcept;
     size_t getNumPreloadedSamples() const noexcept;
 
     void setSamplesPerBlock(int samplesPerBlock) noexcept;
     void setSampleRate(float sampleRate) noexcept;
+    /**
+     * @brief Reallocate the voice pool and the file loading queue. All playing
+     * voices are stopped; the audio callback is disabled during the change.
+     */
+    void setNumVoices(int numVoices) noexcept;
+    int getNumVoices() const noexcept;
+    /**
+     * @brief Set the number of threads used to render the voices, including the
+     * thread calling renderBlock().
+     */
+    void setNumThreads(int numThreads) noexcept;
+    int getNumThreads() const noexcept;
+    /**
+     * @brief In deterministic mode, the output does not depend on the number of
+     * threads, at the cost of an extra buffer per voice.
+     */
+    void setDeterministicRendering(bool deterministic) noexcept;
+    /**
+     * @brief Set the interpolation quality used by the regions without a
+     * sample_quality opcode, from 0 to 10. Qualities up to 1 use linear
+     * interpolation, 2 uses a 4-point Hermite interpolation, up to 5 an 8-tap
+     * windowed sinc and above a 16-tap windowed sinc.
+     */
+    void setSampleQuality(int quality) noexcept;
+    int getSampleQuality() const noexcept;
+    /**
+     * @brief Free the released voices whose output stays below a threshold, in dB,
+     * for a number of render quanta of config::renderQuantum frames. Long release
+     * tails on samples that already decayed then stop costing any rendering.
+     * A number of quanta of 0 disables the gate.
+     */
+    void setSilenceGate(float thresholddB, int numQuanta) noexcept;
+    /**
+     * @brief Number of voices freed by the silence gate since the synth was created.
+     */
+    int getNumSilentVoicesFreed() const noexcept;
+    /**
+     * @brief Set how many blocks of samplesPerBlock frames the loading thread keeps
+     * buffered ahead of each voice streaming a sample that does not fit in the
+     * preloaded data. If the streams have to grow, the voices streaming during
+     * the change restart their stream from where they play, and render silence
+     * until the loading thread catches up.
+     */
+    void setStreamingLookahead(int numBlocks) noexcept;
+    int getStreamingLookahead() const noexcept;
+    /**
+     * @brief Limit the rate at which samples are streamed from the disk, in bytes
+     * of decoded audio per second; 0 removes the limit.
+     */
+    void setStreamingReadRate(double bytesPerSecond) noexcept;
+    /**
+     * @brief Number of render quanta where a voice ran out of streamed data since
+     * the synth was created; the missing frames are rendered as silence.
+     */
+    int getNumStreamUnderruns() const noexcept;
+    /**
+     * @brief Stream the uncompressed WAV files from a memory mapping of the file,
+     * shared with the page cache, rather than through libsndfile. Only affects
+     * the notes started afterwards.
+     */
+    void setMemoryMappedStreaming(bool enabled) noexcept;
+    /**
+     * @brief Set the number of threads opening and preloading the samples in
+     * loadSfzFile(); defaults to the number of hardware threads.
+     */
+    void setNumLoadingThreads(int numThreads) noexcept;
+    int getNumLoadingThreads() const noexcept;
+    /**
+     * @brief Set the memory budget, in bytes, of the cache sharing the decoded
+     * files between the notes that play them entirely from memory.
+     */
+    void setFileCacheSize(size_t numBytes) noexcept;
+    /**
+     * @brief Hits, misses and evictions of the decoded file cache since the
+     * instrument was loaded, and its current size in bytes.
+     */
+    FilePool::CacheStatistics getFileCacheStatistics() const noexcept;
     void renderBlock(AudioSpan<float> buffer) noexcept;
+    /**
+     * @brief The MIDI events can be sent from any thread. They are queued and
+     * processed in the order of their delay at the start of the next call to
+     * renderBlock(); delays beyond the block carry over to the following blocks.
+     */
     void noteOn(int delay, int channel, int noteNumber, uint8_t velocity) noexcept;
     void noteOff(int delay, int channel, int noteNumber, uint8_t velocity) noexcept;
     void cc(int delay, int channel, int ccNumber, uint8_t ccValue) noexcept;
@@ -59,7 +148,7 @@ public:
     void aftertouch(int delay, int channel, uint8_t aftertouch) noexcept;
     void tempo(int delay, float secondsPerQuarter) noexcept;
 
-    void getNumActiveVoices() const noexcept;
+    int getNumActiveVoices() const noexcept;
     void garbageCollect() noexcept;
 protected:
     void callback(absl::string_view header, const std::vector<Opcode>& members) final;
@@ -74,14 +163,48 @@ private:
     void handleGlobalOpcodes(const std::vector<Opcode>& members);
     void handleControlOpcodes(const std::vector<Opcode>& members);
     void buildRegion(const std::vector<Opcode>& regionOpcodes);
+    void allocateVoices(int numVoices);
+    void allocateScratchBuffers();
+
+    struct MidiEvent {
+        enum class Type { NoteOn, NoteOff, CC, PitchWheel, Aftertouch, Tempo };
+        Type type;
+        int delay;
+        int channel;
+        int number;
+        int value;
+        float secondsPerQuarter;
+    };
+    void pushEvent(const MidiEvent& event) noexcept;
+    // Move the queued events to the pending events, once per block
+    void drainEvents() noexcept;
+    // Handle the pending events due within the next frames, and shift the delays of the others
+    void processEvents(int numFrames) noexcept;
+    // Move the voices that finished during the last quantum to the free list
+    void retireFinishedVoices() noexcept;
+    // Start loading or streaming the part of the region past the preloaded data
+    void requestFileData(Voice* voice, Region* region) noexcept;
+    // Stream again from their current position the voices whose stream was reallocated
+    void restartStreams() noexcept;
+    unsigned nextFileTicket() noexcept;
+    void handleNoteOn(int delay, int channel, int noteNumber, uint8_t velocity) noexcept;
+    void handleNoteOff(int delay, int channel, int noteNumber, uint8_t velocity) noexcept;
+    void handleCC(int delay, int channel, int ccNumber, uint8_t ccValue) noexcept;
+    void handlePitchWheel(int delay, int channel, int pitch) noexcept;
+    void handleAftertouch(int delay, int channel, uint8_t aftertouch) noexcept;
+    void handleTempo(int delay, float secondsPerQuarter) noexcept;
+    // Events sent from any thread, drained by the audio thread
+    EventQueue<MidiEvent> eventQueue { config::eventQueueSize };
+    // Drained events sorted by delay, including the ones due in a later block
+    std::vector<MidiEvent> pendingEvents;
     
     std::vector<Opcode> globalOpcodes;
     std::vector<Opcode> masterOpcodes;
     std::vector<Opcode> groupOpcodes;
 
-    FilePool filePool;
     MidiState midiState;
     Voice* findFreeVoice() noexcept;
+    Voice* stealVoice() noexcept;
     std::vector<CCNamePair> ccNames;
     absl::optional<uint8_t> defaultSwitch;
     std::set<absl::string_view> unknownOpcodes;
@@ -89,13 +212,41 @@ private:
     using VoicePtrVector = std::vector<Voice*>;
     std::vector<std::unique_ptr<Region>> regions;
     std::vector<std::unique_ptr<Voice>> voices;
-    VoicePtrVector voiceViewArray;
+    // Declared after the voices and regions so that its threads stop before they are destroyed
+    FilePool filePool;
+    // Scratch memory of all the voices, sliced in allocateScratchBuffers()
+    Buffer<float> scratchArena;
+    Buffer<int> indexArena;
+    // Dense list of the voices currently sounding; only these are rendered and receive events
+    VoicePtrVector activeVoices;
+    // Idle voices, taken from the back when a note starts
+    VoicePtrVector freeVoices;
+
+    struct StealCandidate {
+        Voice* voice;
+        uint64_t startOrder;
+    };
+    // The active voices along with the order in which they started. The release
+    // state and the power change on every quantum, so they are only read when a
+    // voice has to be stolen.
+    std::vector<StealCandidate> stealCandidates;
+    uint64_t voiceStartCounter { 0 };
     std::array<RegionPtrVector, 128> noteActivationLists;
     std::array<RegionPtrVector, 128> ccActivationLists;
+    RenderThreadPool renderPool;
+    GeneratorBatch generatorBatch;
+    // Split of the active voices for the current quantum
+    VoicePtrVector renderedVoices;
+    VoicePtrVector batchedVoices;
 
-    AudioBuffer<float> tempBuffer { 2, config::defaultSamplesPerBlock };
     int samplesPerBlock { config::defaultSamplesPerBlock };
     float sampleRate { config::defaultSampleRate };
+    int sampleQuality { Default::sampleQuality };
+    float silenceThreshold { config::silenceThreshold };
+    int silenceQuanta { config::silenceQuanta };
+    std::atomic<int> numSilentVoicesFreed { 0 };
+    int streamingBlocks { config::streamingBlocks };
+    int numLoadingThreads { std::max(static_cast<int>(std::thread::hardware_concurrency()), 1) };
 
     std::uniform_real_distribution<float> randNoteDistribution { 0, 1 };
     unsigned fileTicket { 1 };
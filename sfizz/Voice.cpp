@@ -28,6 +28,7 @@
 #include "MathHelpers.h"
 #include "SIMDHelpers.h"
 #include "SfzHelpers.h"
+#include "Wavetables.h"
 #include "absl/algorithm/container.h"
 #include <memory>
 
@@ -44,6 +45,8 @@ void sfz::Voice::startVoice(Region* region, int delay, int channel, int number,
     triggerValue = value;
 
     this->region = region;
+    silentQuanta = 0;
+    retiredBySilence = false;
 
     ASSERT(delay >= 0);
     if (delay < 0)
@@ -55,48 +58,25 @@ void sfz::Voice::startVoice(Region* region, int delay, int channel, int number,
     speedRatio = static_cast<float>(region->sampleRate / this->sampleRate);
     pitchRatio = region->getBasePitchVariation(number, value);
 
-    baseVolumedB = region->getBaseVolumedB(number);
-
-    auto volumedB { baseVolumedB };
-    if (region->volumeCC)
-        volumedB += normalizeCC(midiState.cc[region->volumeCC->first]) * region->volumeCC->second;
-    volumeEnvelope.reset(db2mag(volumedB));
-    // DBG("Base volume: " << baseVolumedB << " dB - with modifier: " << volumedB << " dB");
-
-    baseGain = region->getBaseGain();
+    float baseGain { region->getBaseGain() };
     baseGain *= region->getCrossfadeGain(midiState.cc);
     if (triggerType != TriggerType::CC)
         baseGain *= region->getNoteGain(number, value);
 
-    float gain { baseGain };
-    if (region->amplitudeCC)
-        gain *= normalizeCC(midiState.cc[region->amplitudeCC->first]) * normalizePercents(region->amplitudeCC->second);
-    amplitudeEnvelope.reset(gain);
-    // DBG("Base gain: " << baseGain << " - with modifier: " << gain);
-
-    basePan = normalizeNegativePercents(region->pan);
-    auto pan { basePan };
-    if (region->panCC)
-        pan += normalizeCC(midiState.cc[region->panCC->first]) * normalizeNegativePercents(region->panCC->second);
-    panEnvelope.reset(pan);
-    // DBG("Base pan: " << basePan << " - with modifier: " << pan);
-
-    basePosition = normalizeNegativePercents(region->position);
-    auto position { basePosition };
-    if (region->positionCC)
-        position += normalizeCC(midiState.cc[region->positionCC->first]) * normalizeNegativePercents(region->positionCC->second);
-    positionEnvelope.reset(position);
-    // DBG("Base position: " << basePosition << " - with modifier: " << position);
-
-    baseWidth = normalizeNegativePercents(region->width);
-    auto width { baseWidth };
-    if (region->widthCC)
-        width += normalizeCC(midiState.cc[region->widthCC->first]) * normalizeNegativePercents(region->widthCC->second);
-    widthEnvelope.reset(width);
-    // DBG("Base width: " << baseWidth << " - with modifier: " << width);
-
-    sourcePosition = region->getOffset();
-    DBG("Offset: " << sourcePosition);
+    modulation.setBaseValue(ModulationTarget::amplitude, baseGain);
+    modulation.setBaseValue(ModulationTarget::volume, region->getBaseVolumedB(number));
+    modulation.setBaseValue(ModulationTarget::pan, normalizeNegativePercents(region->pan));
+    modulation.setBaseValue(ModulationTarget::position, normalizeNegativePercents(region->position));
+    modulation.setBaseValue(ModulationTarget::width, normalizeNegativePercents(region->width));
+    modulation.start(region->modulations);
+
+    if (region->isGenerator()) {
+        sourcePosition = 0;
+        noiseGenerator.seed(Random::randomGenerator());
+    } else {
+        sourcePosition = toFixedPoint(region->getOffset());
+    }
+    DBG("Offset: " << region->getOffset());
     initialDelay = delay + static_cast<uint32_t>(region->getDelay() * sampleRate);
     baseFrequency = midiNoteFrequency(number) * pitchRatio;
     prepareEGEnvelope(initialDelay, value);
@@ -166,31 +146,6 @@ void sfz::Voice::registerCC(int delay, int channel [[maybe_unused]], int ccNumbe
 
     if (region->checkSustain && noteIsOff && ccNumber == config::sustainCC && ccValue < config::halfCCThreshold)
         release(delay);
-
-    if (region->amplitudeCC && ccNumber == region->amplitudeCC->first) {
-        const float newGain { baseGain * normalizeCC(ccValue) * normalizePercents(region->amplitudeCC->second) };
-        amplitudeEnvelope.registerEvent(delay, newGain);
-    }
-
-    if (region->volumeCC && ccNumber == region->volumeCC->first) {
-        const float newVolumedB { baseVolumedB + normalizeCC(ccValue) * region->volumeCC->second };
-        amplitudeEnvelope.registerEvent(delay, db2mag(newVolumedB));
-    }
-
-    if (region->panCC && ccNumber == region->panCC->first) {
-        const float newPan { basePan + normalizeCC(ccValue) * normalizeNegativePercents(region->panCC->second) };
-        panEnvelope.registerEvent(delay, newPan);
-    }
-
-    if (region->positionCC && ccNumber == region->positionCC->first) {
-        const float newPosition { basePosition + normalizeCC(ccValue) * normalizeNegativePercents(region->positionCC->second) };
-        positionEnvelope.registerEvent(delay, newPosition);
-    }
-
-    if (region->widthCC && ccNumber == region->widthCC->first) {
-        const float newWidth { baseWidth + normalizeCC(ccValue) * normalizeNegativePercents(region->widthCC->second) };
-        widthEnvelope.registerEvent(delay, newWidth);
-    }
 }
 
 void sfz::Voice::registerPitchWheel(int delay [[maybe_unused]], int channel [[maybe_unused]], int pitch [[maybe_unused]]) noexcept
@@ -213,31 +168,52 @@ void sfz::Voice::setSampleRate(float sampleRate) noexcept
     this->sampleRate = sampleRate;
 }
 
+void sfz::Voice::setSampleQuality(int quality) noexcept
+{
+    sampleQuality = quality;
+}
+
 void sfz::Voice::setSamplesPerBlock(int samplesPerBlock) noexcept
 {
     this->samplesPerBlock = samplesPerBlock;
-    tempBuffer1.resize(samplesPerBlock);
-    tempBuffer2.resize(samplesPerBlock);
-    tempBuffer3.resize(samplesPerBlock);
-    indexBuffer.resize(samplesPerBlock);
-    tempSpan1 = absl::MakeSpan(tempBuffer1);
-    tempSpan2 = absl::MakeSpan(tempBuffer2);
-    tempSpan3 = absl::MakeSpan(tempBuffer3);
-    indexSpan = absl::MakeSpan(indexBuffer);
+}
+
+void sfz::Voice::setScratchBuffers(absl::Span<float> scratch, absl::Span<int> indices) noexcept
+{
+    const auto size = scratch.size() / numScratchBuffers;
+    ASSERT(size >= static_cast<size_t>(samplesPerBlock));
+    ASSERT(indices.size() >= static_cast<size_t>(samplesPerBlock));
+    tempSpan1 = scratch.subspan(0 * size, size);
+    tempSpan2 = scratch.subspan(1 * size, size);
+    tempSpan3 = scratch.subspan(2 * size, size);
+    tempSpan4 = scratch.subspan(3 * size, size);
+    tempSpan5 = scratch.subspan(4 * size, size);
+    voiceLeft = scratch.subspan(5 * size, size);
+    voiceRight = scratch.subspan(6 * size, size);
+    indexSpan = indices;
 }
 
 void sfz::Voice::renderBlock(AudioSpan<float> buffer) noexcept
 {
-    ASSERT(static_cast<int>(buffer.getNumFrames()) <= samplesPerBlock);
     buffer.fill(0.0f);
+    renderBlockAccumulate(buffer);
+}
+
+void sfz::Voice::renderBlockAccumulate(AudioSpan<float> output) noexcept
+{
+    ASSERT(static_cast<int>(output.getNumFrames()) <= samplesPerBlock);
 
     if (state == State::idle || region == nullptr) {
         powerHistory.push(0.0);
         return;
     }
 
+    modulation.evaluate();
+
+    auto buffer = AudioSpan<float>({ voiceLeft.data(), voiceRight.data() }, output.getNumFrames());
     auto delay = min(static_cast<size_t>(initialDelay), buffer.getNumFrames());
     auto delayed_buffer = buffer.subspan(delay);
+    buffer.first(delay).fill(0.0f);
     initialDelay -= delay;
 
     if (region->isGenerator())
@@ -245,105 +221,217 @@ void sfz::Voice::renderBlock(AudioSpan<float> buffer) noexcept
     else
         fillWithData(delayed_buffer);
 
-    if (region->isStereo())
-        processStereo(buffer);
-    else
-        processMono(buffer);
+    const auto power = region->isStereo() ? processStereo(buffer, output) : processMono(buffer, output);
+    if (!egEnvelope.isSmoothing() || isTailSilent(power))
+        reset();
+}
 
-    if (!egEnvelope.isSmoothing())
+bool sfz::Voice::isBatchable() const noexcept
+{
+    if (state == State::idle || region == nullptr || initialDelay > 0)
+        return false;
+
+    switch (region->generator) {
+    case SfzGenerator::sine:
+    case SfzGenerator::triangle:
+    case SfzGenerator::saw:
+    case SfzGenerator::square:
+        return true;
+    default:
+        return false;
+    }
+}
+
+sfz::Voice::WavetableBlock sfz::Voice::beginWavetableBlock(int numFrames) noexcept
+{
+    ASSERT(isBatchable());
+    ASSERT(numFrames <= samplesPerBlock);
+    modulation.evaluate();
+
+    // Both channels of a generator carry the same signal so the side channel is
+    // silent, and the stereo mix reduces to the gain times the sine of the width.
+    auto gain = tempSpan1.first(numFrames);
+    auto widthCos = tempSpan2.first(numFrames);
+    auto widthSin = tempSpan3.first(numFrames);
+    if (auto constantGain = gainEnvelope(gain))
+        fill<float>(gain, *constantGain);
+    panCoefficients(ModulationTarget::width, widthCos, widthSin);
+    applyGain<float>(widthSin, gain);
+    lastGain = gain.empty() ? 0.0f : gain.back();
+
+    const float step = baseFrequency * WavetableBank::tableSize / sampleRate;
+    const auto table = WavetableBank::get().getTable(region->generator, step);
+    return { table.data(), sourcePosition, toFixedPoint(step), gain.data() };
+}
+
+void sfz::Voice::endWavetableBlock(uint64_t position, float power) noexcept
+{
+    sourcePosition = position;
+    powerHistory.push(power);
+    if (!egEnvelope.isSmoothing() || isTailSilent(power))
         reset();
+}
 
-    powerHistory.push(buffer.meanSquared());
+void sfz::Voice::setSilenceGate(float thresholddB, int numQuanta) noexcept
+{
+    silenceThreshold = db2pow(thresholddB);
+    silenceQuanta = numQuanta;
 }
 
-void sfz::Voice::processMono(AudioSpan<float> buffer) noexcept
+bool sfz::Voice::isTailSilent(float power) noexcept
 {
-    const auto numSamples = buffer.getNumFrames();
-    auto leftBuffer = buffer.getSpan(0);
-    auto rightBuffer = buffer.getSpan(1);
+    // Only released voices are gated: their gain can only decrease from here,
+    // while a held note may just be going through a quiet part of its sample.
+    if (silenceQuanta <= 0 || state != State::release || power >= silenceThreshold) {
+        silentQuanta = 0;
+        return false;
+    }
 
-    auto span1 = tempSpan1.first(numSamples);
-    auto span2 = tempSpan2.first(numSamples);
+    if (++silentQuanta < silenceQuanta)
+        return false;
+
+    // The output has been quiet long enough; make sure that the part of the
+    // source coming next, weighted by the current gain, is quiet as well.
+    // Generators are periodic so their next period sounds like the last one.
+    if (!region->isGenerator()) {
+        const auto gainSquared = lastGain * lastGain;
+        auto isLoud = [gainSquared, this](AudioSpan<const float> source, size_t offset, size_t numFrames) {
+            for (int channel = 0; channel < source.getNumChannels() && numFrames > 0; ++channel) {
+                const auto ahead = source.getConstSpan(channel).subspan(offset, numFrames);
+                if (meanSquared<float>(ahead) * gainSquared >= silenceThreshold)
+                    return true;
+            }
+            return false;
+        };
+
+        auto source = currentSource();
+        const auto numSourceFrames = source.getNumFrames();
+        const auto sourceFrame = static_cast<size_t>(sourcePosition >> 32);
+        const auto position = min(sourceFrame, numSourceFrames);
+        const auto lookahead = min(numSourceFrames - position, static_cast<size_t>(config::silenceLookahead));
+        bool loud = isLoud(source, position, lookahead);
+
+        // Past the preloaded frames, look at what the stream has buffered
+        if (!loud && isStreaming() && sourceFrame >= numSourceFrames && stream->isReady(streamTicket)) {
+            auto frames = stream->getFrames();
+            const auto ringEnd = static_cast<size_t>(stream->getCapacity() + FileStream::guardFrames);
+            auto frame = static_cast<int>(sourceFrame);
+            const auto end = min(stream->getWrittenEnd(), frame + config::silenceLookahead);
+            while (!loud && frame < end) {
+                const auto index = static_cast<size_t>(stream->getRingIndex(frame));
+                const auto numFrames = min(static_cast<size_t>(end - frame), ringEnd - index);
+                loud = isLoud(frames, index, numFrames);
+                frame += static_cast<int>(numFrames);
+            }
+        }
 
-    // Amplitude envelope
-    amplitudeEnvelope.getBlock(span1);
-    applyGain<float>(span1, leftBuffer);
+        if (loud) {
+            silentQuanta = 0;
+            return false;
+        }
+    }
 
-    // AmpEG envelope
-    egEnvelope.getBlock(span1);
-    applyGain<float>(span1, leftBuffer);
+    DBG("Freeing a silent voice playing " << region->sample);
+    retiredBySilence = true;
+    return true;
+}
 
-    // Volume envelope
-    volumeEnvelope.getBlock(span1);
-    applyGain<float>(span1, leftBuffer);
+bool sfz::Voice::wasRetiredBySilence() const noexcept
+{
+    return retiredBySilence;
+}
+
+absl::optional<float> sfz::Voice::gainEnvelope(absl::Span<float> gain) noexcept
+{
+    // Multiply the amplitude, AmpEG and volume envelopes in a single gain.
+    // Envelopes that are flat over the block are folded in a scalar gain.
+    ASSERT(tempSpan5.size() >= gain.size());
+    auto span = tempSpan5.first(gain.size());
+    float constantGain { 1.0f };
+    bool gainWritten { false };
+
+    auto applyEnvelope = [&](auto&& getBlockOrConstant) {
+        if (auto value = getBlockOrConstant(gainWritten ? span : gain))
+            constantGain *= *value;
+        else if (gainWritten)
+            applyGain<float>(span, gain);
+        else
+            gainWritten = true;
+    };
+
+    applyEnvelope([&](absl::Span<float> output) { return modulation.getBlockOrConstant(ModulationTarget::amplitude, output); });
+    applyEnvelope([&](absl::Span<float> output) { return egEnvelope.getBlockOrConstant(output); });
+    applyEnvelope([&](absl::Span<float> output) { return modulation.getBlockOrConstant(ModulationTarget::volume, output); });
 
-    // Prepare for stereo output
-    copy<float>(leftBuffer, rightBuffer);
+    if (!gainWritten)
+        return constantGain;
 
-    panEnvelope.getBlock(span1);
-    // We assume that the pan envelope is already normalized between -1 and 1
-    // Check bm_pan for your architecture to check if it's interesting to use the pan helper instead
-    fill<float>(span2, 1.0f);
-    add<float>(span1, span2);
-    applyGain<float>(piFour<float>, span2);
-    cos<float>(span2, span1);
-    sin<float>(span2, span2);
-    applyGain<float>(span1, leftBuffer);
-    applyGain<float>(span2, rightBuffer);
+    if (constantGain != 1.0f)
+        applyGain<float>(constantGain, gain);
+
+    return absl::nullopt;
 }
 
-void sfz::Voice::processStereo(AudioSpan<float> buffer) noexcept
+void sfz::Voice::panCoefficients(ModulationTarget target, absl::Span<float> cosSpan, absl::Span<float> sinSpan) noexcept
+{
+    // We assume that the target is already normalized between -1 and 1.
+    // A flat target only needs the pan law computed once for the block.
+    if (auto value = modulation.getBlockOrConstant(target, sinSpan)) {
+        const auto circlePan = piFour<float> * (1.0f + clamp(*value, -1.0f, 1.0f));
+        fill<float>(cosSpan, std::cos(circlePan));
+        fill<float>(sinSpan, std::sin(circlePan));
+    } else {
+        panLaw<float>(sinSpan, cosSpan, sinSpan);
+    }
+}
+
+float sfz::Voice::processMono(AudioSpan<float> buffer, AudioSpan<float> output) noexcept
 {
     const auto numSamples = buffer.getNumFrames();
-    auto span1 = tempSpan1.first(numSamples);
-    auto span2 = tempSpan2.first(numSamples);
-    auto span3 = tempSpan3.first(numSamples);
-    auto leftBuffer = buffer.getSpan(0);
-    auto rightBuffer = buffer.getSpan(1);
-
-    // Amplitude envelope
-    amplitudeEnvelope.getBlock(span1);
-    buffer.applyGain(span1);
-
-    // AmpEG envelope
-    egEnvelope.getBlock(span1);
-    buffer.applyGain(span1);
-
-    // Volume envelope
-    volumeEnvelope.getBlock(span1);
-    buffer.applyGain(span1);
-
-    // Create mid/side from left/right in the output buffer
-    copy<float>(rightBuffer, span1);
-    add<float>(leftBuffer, rightBuffer);
-    subtract<float>(span1, leftBuffer);
-    applyGain<float>(sqrtTwoInv<float>, leftBuffer);
-    applyGain<float>(sqrtTwoInv<float>, rightBuffer);
-
-    // Apply the width process
-    widthEnvelope.getBlock(span1);
-    fill<float>(span2, 1.0f);
-    add<float>(span1, span2);
-    applyGain<float>(piFour<float>, span2);
-    cos<float>(span2, span1);
-    sin<float>(span2, span2);
-    applyGain<float>(span1, leftBuffer);
-    applyGain<float>(span2, rightBuffer);
+    auto gain = tempSpan1.first(numSamples);
+    auto panCos = tempSpan2.first(numSamples);
+    auto panSin = tempSpan3.first(numSamples);
+
+    if (auto constantGain = gainEnvelope(gain))
+        fill<float>(gain, *constantGain);
+    panCoefficients(ModulationTarget::pan, panCos, panSin);
+
+    const auto power = monoMix<float>(gain, panCos, panSin, buffer.getConstSpan(0), output.getSpan(0), output.getSpan(1));
+    powerHistory.push(power);
+    lastGain = gain.empty() ? 0.0f : gain.back();
+    return power;
+}
 
+float sfz::Voice::processStereo(AudioSpan<float> buffer, AudioSpan<float> output) noexcept
+{
+    const auto numSamples = buffer.getNumFrames();
+    auto gain = tempSpan1.first(numSamples);
+    auto widthCos = tempSpan2.first(numSamples);
+    auto widthSin = tempSpan3.first(numSamples);
+    auto positionCos = tempSpan4.first(numSamples);
+    auto positionSin = tempSpan5.first(numSamples);
+
+    // The gain envelope uses the last span as scratch so compute it first
+    if (auto constantGain = gainEnvelope(gain))
+        fill<float>(gain, *constantGain);
+    panCoefficients(ModulationTarget::width, widthCos, widthSin);
     // Apply a position to the "left" channel which is supposed to be our mid channel
     // TODO: add panning here too?
-    positionEnvelope.getBlock(span1);
-    fill<float>(span2, 1.0f);
-    add<float>(span1, span2);
-    applyGain<float>(piFour<float>, span2);
-    cos<float>(span2, span1);
-    sin<float>(span2, span2);
-    copy<float>(leftBuffer, span3);
-    copy<float>(rightBuffer, leftBuffer);
-    multiplyAdd<float>(span1, span3, leftBuffer);
-    multiplyAdd<float>(span2, span3, rightBuffer);
-    applyGain<float>(sqrtTwoInv<float>, leftBuffer);
-    applyGain<float>(sqrtTwoInv<float>, rightBuffer);
+    panCoefficients(ModulationTarget::position, positionCos, positionSin);
+
+    const auto power = stereoMix<float>(gain, widthCos, widthSin, positionCos, positionSin,
+        buffer.getConstSpan(0), buffer.getConstSpan(1), output.getSpan(0), output.getSpan(1));
+    powerHistory.push(power);
+    lastGain = gain.empty() ? 0.0f : gain.back();
+    return power;
+}
+
+sfz::AudioSpan<const float> sfz::Voice::currentSource() const noexcept
+{
+    if (region->canUsePreloadedData() || !dataReady)
+        return AudioSpan<const float>(*region->preloadedData);
+
+    return AudioSpan<const float>(*fileData);
 }
 
 void sfz::Voice::fillWithData(AudioSpan<float> buffer) noexcept
@@ -351,103 +439,181 @@ void sfz::Voice::fillWithData(AudioSpan<float> buffer) noexcept
     if (buffer.getNumFrames() == 0)
         return;
 
-    auto source { [&]() {
-        if (region->canUsePreloadedData())
-            return AudioSpan<const float>(*region->preloadedData);
-        else if (!dataReady)
-            return AudioSpan<const float>(*region->preloadedData);
-        else
-            return AudioSpan<const float>(*fileData);
-    }() };
-
-    auto indices = indexSpan.first(buffer.getNumFrames());
-    auto jumps = tempSpan1.first(buffer.getNumFrames());
-    auto leftCoeffs = tempSpan1.first(buffer.getNumFrames());
-    auto rightCoeffs = tempSpan2.first(buffer.getNumFrames());
-
-    fill<float>(jumps, pitchRatio * speedRatio);
-    jumps[0] += floatPositionOffset;
-    cumsum<float>(jumps, jumps);
-    sfzInterpolationCast<float>(jumps, indices, leftCoeffs, rightCoeffs);
-    add<int>(sourcePosition, indices);
-
-    //FIXME : all this casting is driving me crazy
-    const auto sampleEnd = min(static_cast<int>(region->trueSampleEnd()), static_cast<int>(source.getNumFrames())) - 1;
-    if (region->shouldLoop() && region->loopRange.getEnd() <= source.getNumFrames()) {
-        const auto offset = sampleEnd - static_cast<int>(region->loopRange.getStart());
-        for (auto* index = indices.begin(); index < indices.end(); ++index) {
-            if (*index > sampleEnd) {
-                const auto remainingElements = static_cast<size_t>(std::distance(index, indices.end()));
-                subtract<int>(offset, { index, remainingElements });
-            }
-        }
-    } else {
-        for (auto* index = indices.begin(); index < indices.end(); ++index) {
-            if (*index > sampleEnd) {
-                const auto remainingElements = static_cast<size_t>(std::distance(index, indices.end()));
-                fill<int>(indices.last(remainingElements), sampleEnd);
-                fill<float>(leftCoeffs.last(remainingElements), 0.0f);
-                fill<float>(rightCoeffs.last(remainingElements), 1.0f);
-                break;
-            }
-        }
+    auto source = currentSource();
+    const auto numFrames = buffer.getNumFrames();
+    auto indices = indexSpan.first(numFrames);
+    auto leftCoeffs = tempSpan1.first(numFrames);
+    auto rightCoeffs = tempSpan2.first(numFrames);
+
+    // The interpolation reads one frame past the index, so the last usable
+    // position is one frame before the end of the source. A streamed source
+    // covers the whole region.
+    const auto numSourceFrames = isStreaming() ? static_cast<int64_t>(region->trueSampleEnd()) : static_cast<int64_t>(source.getNumFrames());
+    const auto sampleEnd = static_cast<int>(min<int64_t>(region->trueSampleEnd(), numSourceFrames - 1));
+    if (sampleEnd < 1) {
+        buffer.fill(0.0f);
+        if (state != State::release)
+            release(0);
+        return;
     }
 
-    auto ind = indices.data();
-    auto leftCoeff = leftCoeffs.data();
-    auto rightCoeff = rightCoeffs.data();
-    auto left = buffer.getChannel(0);
-    auto leftSource = source.getChannel(0);
-    if (source.getNumChannels() == 1) {
-        while (ind < indices.end()) {
-            *left = leftSource[*ind] * (*leftCoeff) + leftSource[*ind + 1] * (*rightCoeff);
-            left++;
-            ind++;
-            leftCoeff++;
-            rightCoeff++;
-        }
-    } else {
-        auto right = buffer.getChannel(1);
-        auto rightSource = source.getChannel(1);
-        while (ind < indices.end()) {
-            *left = leftSource[*ind] * (*leftCoeff) + leftSource[*ind + 1] * (*rightCoeff);
-            *right = rightSource[*ind] * (*leftCoeff) + rightSource[*ind + 1] * (*rightCoeff);
-            left++;
-            right++;
-            ind++;
-            leftCoeff++;
-            rightCoeff++;
-        }
+    const auto loopStart = static_cast<int>(region->loopRange.getStart());
+    const bool looping = region->shouldLoop()
+        && region->loopRange.getEnd() <= source.getNumFrames()
+        && loopStart < sampleEnd;
+
+    const auto step = toFixedPoint(pitchRatio * speedRatio);
+    const auto end = toFixedPoint(sampleEnd);
+    if (looping)
+        sourcePosition = loopingFixedPointIndex<float>(leftCoeffs, rightCoeffs, indices, sourcePosition, step, end, toFixedPoint(loopStart));
+    else
+        sourcePosition = saturatingFixedPointIndex<float>(leftCoeffs, rightCoeffs, indices, sourcePosition, step, end);
+
+    // Find the end of the sample before the streaming remaps the indices
+    auto last = static_cast<int>(numFrames);
+    const bool reachedEnd = state != State::release && !looping && sourcePosition >= end;
+    if (reachedEnd) {
+        // The first saturated frame is the one reading the last sample with a unit coefficient
+        const auto lastIndex = sampleEnd - 1;
+        last = 0;
+        while (last < static_cast<int>(numFrames) && (indices[last] != lastIndex || rightCoeffs[last] < 1.0f))
+            last++;
     }
 
-    sourcePosition = indices.back();
-    floatPositionOffset = rightCoeffs.back();
+    if (isStreaming())
+        interpolateStream(source, indices, leftCoeffs, rightCoeffs, buffer);
+    else
+        interpolate(source, indices, leftCoeffs, rightCoeffs, buffer);
 
-    if (state != State::release && !region->shouldLoop() && sourcePosition == sampleEnd) {
+    if (reachedEnd) {
         DBG("Releasing " << region->sample);
-        auto last = std::distance(indices.begin(), absl::c_find(indices, sampleEnd));
         release(last);
         buffer.subspan(last).fill(0.0f);
     }
 }
 
-void sfz::Voice::fillWithGenerator(AudioSpan<float> buffer) noexcept
+void sfz::Voice::interpolate(AudioSpan<const float> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, AudioSpan<float> buffer) noexcept
+{
+    const auto quality = region->sampleQuality.value_or(sampleQuality);
+    if (quality <= 1) {
+        if (source.getNumChannels() == 1) {
+            linearInterpolation<float>(source.getConstSpan(0), indices, leftCoeffs, rightCoeffs, buffer.getSpan(0));
+        } else {
+            linearInterpolation<float>(source.getConstSpan(0), source.getConstSpan(1), indices, leftCoeffs, rightCoeffs,
+                buffer.getSpan(0), buffer.getSpan(1));
+        }
+    } else {
+        const auto taps = quality > 5 ? 16 : 8;
+        for (int channel = 0; channel < source.getNumChannels(); ++channel) {
+            if (quality == 2)
+                hermiteInterpolation<float>(source.getConstSpan(channel), indices, rightCoeffs, buffer.getSpan(channel));
+            else
+                sincInterpolation<float>(source.getConstSpan(channel), indices, rightCoeffs, buffer.getSpan(channel), taps);
+        }
+    }
+}
+
+void sfz::Voice::interpolateStream(AudioSpan<const float> preloaded, absl::Span<int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, AudioSpan<float> buffer) noexcept
 {
-    if (region->sample != "*sine")
+    // The interpolators read at most this many frames on each side of an index
+    constexpr int margin { FileStream::guardFrames / 2 };
+    const auto numFrames = indices.size();
+
+    // The frames whose neighbors are all preloaded are read from there
+    const auto numPreloaded = static_cast<int>(preloaded.getNumFrames());
+    const auto split = static_cast<size_t>(absl::c_lower_bound(indices, numPreloaded - margin) - indices.begin());
+    if (split > 0)
+        interpolate(preloaded, indices.first(split), leftCoeffs.first(split), rightCoeffs.first(split), buffer.first(split));
+
+    if (split == numFrames)
         return;
 
-    if (buffer.getNumFrames() == 0)
+    // The others come from the stream, as far as it has been written
+    auto available = split;
+    if (stream->isReady(streamTicket)) {
+        stream->setReadPosition(indices[split] - margin);
+        const auto writtenEnd = stream->getWrittenEnd();
+        available = static_cast<size_t>(std::lower_bound(indices.begin() + split, indices.end(), writtenEnd - margin) - indices.begin());
+        for (auto i = split; i < available; ++i)
+            indices[i] = stream->getRingIndex(indices[i]);
+
+        const auto size = available - split;
+        interpolate(stream->getFrames(), indices.subspan(split, size), leftCoeffs.subspan(split, size),
+            rightCoeffs.subspan(split, size), buffer.subspan(split, size));
+    }
+
+    if (available < numFrames) {
+        buffer.subspan(available).fill(0.0f);
+        stream->countUnderrun();
+    }
+}
+
+bool sfz::Voice::isStreaming() const noexcept
+{
+    return streamTicket != 0;
+}
+
+void sfz::Voice::setStream(FileStream* stream) noexcept
+{
+    this->stream = stream;
+}
+
+sfz::FileStream* sfz::Voice::getStream() noexcept
+{
+    return stream;
+}
+
+void sfz::Voice::expectStream(unsigned ticket) noexcept
+{
+    ASSERT(stream != nullptr);
+    streamTicket = ticket;
+}
+
+bool sfz::Voice::hasDataFor(int numFrames) const noexcept
+{
+    if (state == State::idle || region == nullptr || region->isGenerator() || region->canUsePreloadedData())
+        return true;
+
+    if (!isStreaming())
+        return dataReady;
+
+    if (!stream->isReady(streamTicket))
+        return false;
+
+    // The interpolators read a few frames past the last index
+    const auto end = min(static_cast<int>(getSourcePosition()) + numFrames, static_cast<int>(region->trueSampleEnd()));
+    return stream->getWrittenEnd() >= end + FileStream::guardFrames;
+}
+
+void sfz::Voice::fillWithGenerator(AudioSpan<float> buffer) noexcept
+{
+    const auto numFrames = buffer.getNumFrames();
+    if (numFrames == 0)
         return;
 
-    float step = baseFrequency * twoPi<float> / sampleRate;
-    phase = linearRamp<float>(tempSpan1, phase, step);
+    switch (region->generator) {
+    case SfzGenerator::silence:
+        buffer.fill(0.0f);
+        return;
+    case SfzGenerator::noise:
+        for (auto& value : buffer.getSpan(0))
+            value = noiseDistribution(noiseGenerator);
+        copy<float>(buffer.getSpan(0), buffer.getSpan(1));
+        return;
+    default:
+        break;
+    }
 
-    sin<float>(tempSpan1.first(buffer.getNumFrames()), buffer.getSpan(0));
+    // The periodic generators loop over a band-limited table like a sample would
+    constexpr auto tableSize = WavetableBank::tableSize;
+    const float step = baseFrequency * tableSize / sampleRate;
+    const auto table = WavetableBank::get().getTable(region->generator, step);
+    auto indices = indexSpan.first(numFrames);
+    auto leftCoeffs = tempSpan1.first(numFrames);
+    auto rightCoeffs = tempSpan2.first(numFrames);
+    sourcePosition = loopingFixedPointIndex<float>(leftCoeffs, rightCoeffs, indices, sourcePosition, toFixedPoint(step), toFixedPoint(tableSize), 0);
+    linearInterpolation<float>(table, indices, leftCoeffs, rightCoeffs, buffer.getSpan(0));
     copy<float>(buffer.getSpan(0), buffer.getSpan(1));
-
-    // Wrap the phase so we don't loose too much precision on longer notes
-    const auto numTwoPiWraps = static_cast<int>(phase / twoPi<float>);
-    phase -= twoPi<float> * static_cast<float>(numTwoPiWraps);
 }
 
 bool sfz::Voice::checkOffGroup(int delay, uint32_t group) noexcept
@@ -491,8 +657,13 @@ void sfz::Voice::reset() noexcept
     }
     region = nullptr;
     sourcePosition = 0;
-    floatPositionOffset = 0.0f;
     noteIsOff = false;
+    if (isStreaming()) {
+        stream->request(0, 0);
+        streamTicket = 0;
+    }
+    // Idle voices are not rendered anymore, so start the next note with a clean history
+    powerHistory.reset();
 }
 
 void sfz::Voice::garbageCollect() noexcept
@@ -519,5 +690,10 @@ bool sfz::Voice::canBeStolen() const noexcept
 
 uint32_t sfz::Voice::getSourcePosition() const noexcept
 {
-    return sourcePosition;
+    return static_cast<uint32_t>(sourcePosition >> 32);
+}
+
+const sfz::Region* sfz::Voice::getRegion() const noexcept
+{
+    return region;
 }
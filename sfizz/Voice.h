@@ -24,16 +24,19 @@
 #pragma once
 #include "ADSREnvelope.h"
 #include "Config.h"
-#include "LinearEnvelope.h"
+#include "ModulationMatrix.h"
 #include "HistoricalBuffer.h"
 #include "Region.h"
 #include "AudioBuffer.h"
 #include "MidiState.h"
 #include "AudioSpan.h"
+#include "FileStream.h"
 #include "LeakDetector.h"
+#include "MathHelpers.h"
 #include <absl/types/span.h>
 #include <atomic>
 #include <memory>
+#include <random>
 
 namespace sfz {
 class Voice {
@@ -47,10 +50,61 @@ public:
     };
     void setSampleRate(float sampleRate) noexcept;
     void setSamplesPerBlock(int samplesPerBlock) noexcept;
+    /**
+     * @brief Number of float scratch buffers a voice needs, each one holding at
+     * least a block: 5 temporaries and the 2 channels of the voice buffer.
+     */
+    static constexpr int numScratchBuffers { 7 };
+    /**
+     * @brief Hand the voice its scratch memory. The voice does not own the memory,
+     * which is carved out of a contiguous arena shared by all voices.
+     *
+     * @param scratch numScratchBuffers buffers of equal size, laid out one after the other
+     * @param indices at least a block of indices
+     */
+    void setScratchBuffers(absl::Span<float> scratch, absl::Span<int> indices) noexcept;
+    /**
+     * @brief Set the interpolation quality used when the region does not
+     * specify one through sample_quality.
+     */
+    void setSampleQuality(int quality) noexcept;
+    /**
+     * @brief Free released voices once their output stays below a threshold for
+     * a number of render quanta, and the source coming next is quiet as well.
+     *
+     * @param thresholddB the threshold on the mean squared output, in dB
+     * @param numQuanta the number of consecutive quiet quanta; 0 disables the gate
+     */
+    void setSilenceGate(float thresholddB, int numQuanta) noexcept;
+    /**
+     * @brief Whether the last voice was freed by the silence gate rather than
+     * by the end of its envelope. Valid until the voice starts again.
+     */
+    bool wasRetiredBySilence() const noexcept;
     
     void startVoice(Region* region, int delay, int channel, int number, uint8_t value, TriggerType triggerType) noexcept;
 
     void expectFileData(unsigned ticket);
+    /**
+     * @brief Give the voice the stream it reads from when its region does not fit
+     * in the preloaded data. The stream belongs to the file pool.
+     */
+    void setStream(FileStream* stream) noexcept;
+    FileStream* getStream() noexcept;
+    /**
+     * @brief Read the data past the preloaded frames from the stream, once the
+     * loading thread serves this ticket. Stops when the voice is reset.
+     */
+    void expectStream(unsigned ticket) noexcept;
+    bool isStreaming() const noexcept;
+    /**
+     * @brief Whether the data of the next frames of the source is in memory: the
+     * region fits in the preloaded data, the file was loaded, or the stream is
+     * written far enough. Free voices and generators always have their data.
+     *
+     * @param numFrames a number of source frames past the current position
+     */
+    bool hasDataFor(int numFrames) const noexcept;
     void setFileData(std::shared_ptr<AudioBuffer<float>> file, unsigned ticket) noexcept;
     void registerNoteOff(int delay, int channel, int noteNumber, uint8_t velocity) noexcept;
     void registerCC(int delay, int channel, int ccNumber, uint8_t ccValue) noexcept;
@@ -60,6 +114,40 @@ public:
     bool checkOffGroup(int delay, uint32_t group) noexcept;
 
     void renderBlock(AudioSpan<float, 2> buffer) noexcept;
+    /**
+     * Render the voice and add it to the output, without going through an intermediate
+     * stereo buffer. The last stereo stage of the voice processing is done as a
+     * multiply-add directly into the output.
+     */
+    void renderBlockAccumulate(AudioSpan<float, 2> output) noexcept;
+
+    /**
+     * @brief Oscillator state of a periodic generator, handed to the batched
+     * wavetable kernel. The gain includes the stereo width and lives in the
+     * voice scratch memory until the next render.
+     */
+    struct WavetableBlock {
+        const float* table;
+        uint64_t position;
+        uint64_t step;
+        const float* gain;
+    };
+    /**
+     * @brief Whether the voice can be rendered through beginWavetableBlock() and
+     * endWavetableBlock() instead of renderBlockAccumulate(): a periodic generator
+     * whose initial delay has elapsed.
+     */
+    bool isBatchable() const noexcept;
+    /**
+     * @brief Evaluate the envelopes of a batchable voice for the next numFrames
+     * frames and return its oscillator state.
+     */
+    WavetableBlock beginWavetableBlock(int numFrames) noexcept;
+    /**
+     * @brief Store the oscillator state of a batchable voice after the batched
+     * kernel ran, along with the mean squared value it rendered.
+     */
+    void endWavetableBlock(uint64_t position, float power) noexcept;
 
     bool isFree() const noexcept;
     bool canBeStolen() const noexcept;
@@ -73,12 +161,19 @@ public:
 
     float getMeanSquaredAverage() const noexcept;
     uint32_t getSourcePosition() const noexcept;
+    const Region* getRegion() const noexcept;
 private:
     void fillWithData(AudioSpan<float> buffer) noexcept;
+    void interpolate(AudioSpan<const float> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, AudioSpan<float> buffer) noexcept;
+    void interpolateStream(AudioSpan<const float> preloaded, absl::Span<int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, AudioSpan<float> buffer) noexcept;
     void fillWithGenerator(AudioSpan<float> buffer) noexcept;
     void prepareEGEnvelope(int delay, uint8_t velocity) noexcept;
-    void processMono(AudioSpan<float> buffer) noexcept;
-    void processStereo(AudioSpan<float> buffer) noexcept;
+    absl::optional<float> gainEnvelope(absl::Span<float> gain) noexcept;
+    void panCoefficients(ModulationTarget target, absl::Span<float> cosSpan, absl::Span<float> sinSpan) noexcept;
+    AudioSpan<const float> currentSource() const noexcept;
+    float processMono(AudioSpan<float> buffer, AudioSpan<float> output) noexcept;
+    float processStereo(AudioSpan<float> buffer, AudioSpan<float> output) noexcept;
+    bool isTailSilent(float power) noexcept;
     void release(int delay) noexcept;
     Region* region { nullptr };
 
@@ -97,43 +192,42 @@ private:
 
     float speedRatio { 1.0 };
     float pitchRatio { 1.0 };
-    float baseVolumedB{ 0.0 };
-    float baseGain { 1.0 };
-    float basePan { 0.0 };
-    float basePosition { 0.0 };
-    float baseWidth { 0.0 };
     float baseFrequency { 440.0 };
-    float phase { 0.0f };
+    std::minstd_rand noiseGenerator;
+    std::uniform_real_distribution<float> noiseDistribution { -1.0f, 1.0f };
 
-    float floatPositionOffset { 0.0f };
-    int sourcePosition { 0 };
+    uint64_t sourcePosition { 0 }; // 32.32 fixed point, see toFixedPoint()
     int initialDelay { 0 };
 
     std::atomic<bool> dataReady { false };
     std::shared_ptr<AudioBuffer<float>> fileData { nullptr };
     unsigned ticket { 0 };
-
-    Buffer<float> tempBuffer1;
-    Buffer<float> tempBuffer2;
-    Buffer<float> tempBuffer3;
-    Buffer<int> indexBuffer;
-    absl::Span<float> tempSpan1 { absl::MakeSpan(tempBuffer1) };
-    absl::Span<float> tempSpan2 { absl::MakeSpan(tempBuffer2) };
-    absl::Span<float> tempSpan3 { absl::MakeSpan(tempBuffer3) };
-    absl::Span<int> indexSpan { absl::MakeSpan(indexBuffer) };
+    FileStream* stream { nullptr };
+    unsigned streamTicket { 0 };
+
+    absl::Span<float> tempSpan1;
+    absl::Span<float> tempSpan2;
+    absl::Span<float> tempSpan3;
+    absl::Span<float> tempSpan4;
+    absl::Span<float> tempSpan5;
+    absl::Span<float> voiceLeft;
+    absl::Span<float> voiceRight;
+    absl::Span<int> indexSpan;
 
     int samplesPerBlock { config::defaultSamplesPerBlock };
     float sampleRate { config::defaultSampleRate };
+    int sampleQuality { Default::sampleQuality };
 
     const MidiState& midiState;
     ADSREnvelope<float> egEnvelope;
-    LinearEnvelope<float> volumeEnvelope; // dB events but the envelope output is linear gain
-    LinearEnvelope<float> amplitudeEnvelope; // linear events
-    LinearEnvelope<float> panEnvelope;
-    LinearEnvelope<float> positionEnvelope;
-    LinearEnvelope<float> widthEnvelope;
+    ModulationMatrix modulation { midiState };
 
     HistoricalBuffer<float> powerHistory { config::powerHistoryLength };
+    float lastGain { 0.0f };
+    float silenceThreshold { db2pow(config::silenceThreshold) };
+    int silenceQuanta { config::silenceQuanta };
+    int silentQuanta { 0 };
+    bool retiredBySilence { false };
     LEAK_DETECTOR(Voice);
 };
 
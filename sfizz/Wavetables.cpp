@@ -0,0 +1,112 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Wavetables.h"
+#include "Debug.h"
+#include "MathHelpers.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int tableStride { sfz::WavetableBank::tableSize + 1 };
+
+// Fourier series amplitude of harmonic h, normalized to a unit peak
+double harmonicAmplitude(SfzGenerator generator, int h)
+{
+    switch (generator) {
+    case SfzGenerator::sine:
+        return h == 1 ? 1.0 : 0.0;
+    case SfzGenerator::triangle:
+        if (h % 2 == 0)
+            return 0.0;
+        return (h % 4 == 1 ? 8.0 : -8.0) / (pi<double> * pi<double> * h * h);
+    case SfzGenerator::saw:
+        return (h % 2 == 1 ? 2.0 : -2.0) / (pi<double> * h);
+    case SfzGenerator::square:
+        return h % 2 == 1 ? 4.0 / (pi<double> * h) : 0.0;
+    default:
+        return 0.0;
+    }
+}
+}
+
+const sfz::WavetableBank& sfz::WavetableBank::get()
+{
+    static const WavetableBank bank;
+    return bank;
+}
+
+sfz::WavetableBank::WavetableBank()
+{
+    // The harmonic h of sample n is read from a single sine period at (h * n) mod tableSize
+    std::vector<double> sine(tableSize);
+    for (int n = 0; n < tableSize; ++n)
+        sine[n] = std::sin(twoPi<double> * n / tableSize);
+
+    const SfzGenerator waveforms[numWaveforms] { SfzGenerator::sine, SfzGenerator::triangle, SfzGenerator::saw, SfzGenerator::square };
+    data.resize(numWaveforms * numLevels * tableStride);
+    std::vector<double> table(tableSize);
+    for (auto waveform : waveforms) {
+        for (int level = 0; level < numLevels; ++level) {
+            // Read with a step of up to 2^level, the harmonics up to tableSize / 2^(level + 1) do not alias
+            const int numHarmonics = (tableSize / 2) >> level;
+            std::fill(table.begin(), table.end(), 0.0);
+            for (int h = 1; h <= numHarmonics; ++h) {
+                const double amplitude = harmonicAmplitude(waveform, h);
+                if (amplitude == 0.0)
+                    continue;
+                for (int n = 0; n < tableSize; ++n)
+                    table[n] += amplitude * sine[(h * n) & (tableSize - 1)];
+            }
+
+            auto* output = &data[(waveformIndex(waveform) * numLevels + level) * tableStride];
+            for (int n = 0; n < tableSize; ++n)
+                output[n] = static_cast<float>(table[n]);
+            output[tableSize] = output[0];
+        }
+    }
+}
+
+int sfz::WavetableBank::waveformIndex(SfzGenerator generator) noexcept
+{
+    switch (generator) {
+    case SfzGenerator::triangle:
+        return 1;
+    case SfzGenerator::saw:
+        return 2;
+    case SfzGenerator::square:
+        return 3;
+    default:
+        ASSERT(generator == SfzGenerator::sine);
+        return 0;
+    }
+}
+
+absl::Span<const float> sfz::WavetableBank::getTable(SfzGenerator generator, float step) const noexcept
+{
+    int level { 0 };
+    while (level < numLevels - 1 && static_cast<float>(1 << level) < step)
+        level++;
+
+    return absl::MakeConstSpan(&data[(waveformIndex(generator) * numLevels + level) * tableStride], tableStride);
+}
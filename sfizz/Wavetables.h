@@ -0,0 +1,62 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "Defaults.h"
+#include "LeakDetector.h"
+#include <absl/types/span.h>
+#include <vector>
+
+namespace sfz {
+/**
+ * @brief Band-limited tables for the periodic generators, shared by all the
+ * voices. Each waveform has one table per octave of playback speed: the table
+ * read with a step of up to 2^level frames only holds the harmonics that stay
+ * below the Nyquist frequency, whatever the sample rate.
+ */
+class WavetableBank {
+public:
+    static constexpr int tableSize { 2048 };
+    static constexpr int numLevels { 11 };
+    /**
+     * @brief Get the bank, which is built on the first call. Call it once
+     * outside of the audio thread before rendering the generators.
+     */
+    static const WavetableBank& get();
+    /**
+     * @brief Get the table to read with a given step
+     *
+     * @param generator a periodic generator (sine, triangle, saw or square)
+     * @param step the number of table frames per output frame
+     * @return tableSize + 1 frames, the last one repeating the first so that
+     *         the interpolation can read past the end
+     */
+    absl::Span<const float> getTable(SfzGenerator generator, float step) const noexcept;
+private:
+    WavetableBank();
+    static constexpr int numWaveforms { 4 };
+    static int waveformIndex(SfzGenerator generator) noexcept;
+    std::vector<float> data;
+    LEAK_DETECTOR(WavetableBank);
+};
+}
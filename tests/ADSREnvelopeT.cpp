@@ -208,4 +208,41 @@ TEST_CASE("[ADSREnvelope] Hold with release 2")
     absl::c_fill(output, -1.0);
     envelope.getBlock(absl::MakeSpan(output));
     REQUIRE(approxEqual<float>(output, expected));
-}
\ No newline at end of file
+}
+
+TEST_CASE("[ADSREnvelope] Constant blocks")
+{
+    sfz::ADSREnvelope<float> envelope;
+    std::array<float, 4> output;
+    REQUIRE(envelope.getBlockOrConstant(absl::MakeSpan(output)) == 0.0f);
+
+    envelope.reset(2, 4, 0.5f, 4, 2, 6);
+    REQUIRE(envelope.getBlockOrConstant(absl::MakeSpan(output)) == 0.0f); // Delay
+    REQUIRE(!envelope.getBlockOrConstant(absl::MakeSpan(output))); // Attack and hold
+    REQUIRE(envelope.getBlockOrConstant(absl::MakeSpan(output)) == 1.0f); // Hold
+    REQUIRE(!envelope.getBlockOrConstant(absl::MakeSpan(output))); // Decay
+    REQUIRE(envelope.getBlockOrConstant(absl::MakeSpan(output)) == 0.5f); // Sustain
+    envelope.startRelease(6);
+    REQUIRE(envelope.getBlockOrConstant(absl::MakeSpan(output)) == 0.5f);
+    REQUIRE(!envelope.getBlockOrConstant(absl::MakeSpan(output))); // Release
+    REQUIRE(output[1] == 0.5f);
+    REQUIRE(output[2] < 0.5f);
+}
+
+TEST_CASE("[ADSREnvelope] Constant blocks match getBlock")
+{
+    sfz::ADSREnvelope<float> reference;
+    sfz::ADSREnvelope<float> envelope;
+    reference.reset(3, 5, 0.5f, 7, 3, 6);
+    envelope.reset(3, 5, 0.5f, 7, 3, 6);
+    reference.startRelease(29);
+    envelope.startRelease(29);
+    std::array<float, 4> expected;
+    std::array<float, 4> output;
+    for (int block = 0; block < 12; ++block) {
+        reference.getBlock(absl::MakeSpan(expected));
+        if (auto value = envelope.getBlockOrConstant(absl::MakeSpan(output)))
+            absl::c_fill(output, *value);
+        REQUIRE(approxEqual<float>(output, expected));
+    }
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "EventQueue.h"
+#include "catch2/catch.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+using namespace Catch::literals;
+
+TEST_CASE("[EventQueue] Push and pop")
+{
+    sfz::EventQueue<int> queue { 5 };
+    REQUIRE( queue.capacity() == 8 );
+    int value { 0 };
+    REQUIRE( !queue.tryPop(value) );
+    for (int i = 0; i < 8; ++i)
+        REQUIRE( queue.tryPush(i) );
+    REQUIRE( !queue.tryPush(8) );
+    for (int i = 0; i < 8; ++i) {
+        REQUIRE( queue.tryPop(value) );
+        REQUIRE( value == i );
+    }
+    REQUIRE( !queue.tryPop(value) );
+}
+
+TEST_CASE("[EventQueue] Wrap around")
+{
+    sfz::EventQueue<int> queue { 4 };
+    int value { 0 };
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE( queue.tryPush(2 * i) );
+        REQUIRE( queue.tryPush(2 * i + 1) );
+        REQUIRE( queue.tryPop(value) );
+        REQUIRE( value == 2 * i );
+        REQUIRE( queue.tryPop(value) );
+        REQUIRE( value == 2 * i + 1 );
+    }
+}
+
+TEST_CASE("[EventQueue] Multiple producers")
+{
+    constexpr int numProducers { 4 };
+    constexpr int numValues { 10000 };
+    sfz::EventQueue<int> queue { 64 };
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < numProducers; ++producer)
+        producers.emplace_back([&queue, producer]() {
+            for (int i = 0; i < numValues; ++i) {
+                while (!queue.tryPush(producer * numValues + i))
+                    std::this_thread::yield();
+            }
+        });
+
+    // Each producer's values come out in order
+    std::vector<int> lastValues(numProducers, -1);
+    int numReceived { 0 };
+    int value { 0 };
+    while (numReceived < numProducers * numValues) {
+        if (queue.tryPop(value)) {
+            const auto producer = value / numValues;
+            REQUIRE( value % numValues == lastValues[producer] + 1 );
+            lastValues[producer] = value % numValues;
+            numReceived++;
+        }
+    }
+    for (auto& producer : producers)
+        producer.join();
+    REQUIRE( std::all_of(lastValues.begin(), lastValues.end(), [](int last) { return last == numValues - 1; }) );
+}
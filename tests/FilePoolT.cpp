@@ -0,0 +1,62 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "FilePool.h"
+#include "catch2/catch.hpp"
+#include "../sfizz/ghc/fs_std.hpp"
+#include <utility>
+#include <vector>
+
+TEST_CASE("[FilePool] File information is read once per file")
+{
+    // Work on a copy, so that the file can disappear
+    const auto directory = fs::temp_directory_path();
+    const std::string sample { "sfizz_file_pool.wav" };
+    fs::copy_file(fs::current_path() / "tests/TestFiles/stereo_sample.wav", directory / sample, fs::copy_options::overwrite_existing);
+
+    sfz::FilePool pool;
+    pool.setRootDirectory(directory);
+    const auto information = pool.getFileInformation(sample, 0);
+    REQUIRE( information );
+    REQUIRE( information->end > sfz::config::preloadSize );
+    REQUIRE( information->preloadedData->getNumChannels() == 2 );
+    REQUIRE( information->preloadedData->getNumFrames() == sfz::config::preloadSize );
+    REQUIRE( pool.getNumPreloadedSamples() == 1 );
+
+    // Offsets within the preloaded data do not touch the file anymore
+    fs::remove(directory / sample);
+    const auto again = pool.getFileInformation(sample, 0);
+    REQUIRE( again );
+    REQUIRE( again->end == information->end );
+    REQUIRE( again->preloadedData == information->preloadedData );
+    const std::vector<std::pair<absl::string_view, uint32_t>> files { { sample, 0 } };
+    const auto scanned = pool.scanFiles(files, 2);
+    REQUIRE( scanned[0] );
+    REQUIRE( scanned[0]->preloadedData == information->preloadedData );
+
+    // A larger offset needs to read the file again
+    REQUIRE( !pool.getFileInformation(sample, 1000) );
+    pool.clear();
+    REQUIRE( pool.getNumPreloadedSamples() == 0 );
+    REQUIRE( !pool.getFileInformation(sample, 0) );
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "FileStream.h"
+#include "catch2/catch.hpp"
+#include "../sfizz/ghc/fs_std.hpp"
+#include <vector>
+
+namespace {
+// Write to the stream what the loading thread would, in chunks of chunkSize frames
+void writeChunk(sfz::FileStream& stream, int lookahead, int chunkSize)
+{
+    std::vector<float> chunk(chunkSize);
+    const auto numFrames = std::min(stream.getFramesToWrite(lookahead), chunkSize);
+    const auto numFileFrames = std::max(std::min(numFrames, stream.getEndFrame() - stream.getNextFileFrame()), 0);
+    const auto framesRead = static_cast<int>(stream.getFile().readf(chunk.data(), numFileFrames));
+    stream.write(sfz::AudioSpan<const float>({ chunk.data() }, framesRead), numFrames);
+}
+}
+
+TEST_CASE("[FileStream] Frames and guards in the ring")
+{
+    const auto path = fs::current_path() / "tests/TestFiles/mono_sample.wav";
+    SndfileHandle reference { path.string().c_str() };
+    REQUIRE( reference.channels() == 1 );
+    std::vector<float> expected(300);
+    reference.readf(expected.data(), expected.size());
+
+    constexpr int capacity { 64 };
+    constexpr int startFrame { 100 };
+    constexpr int endFrame { 250 };
+    sfz::FileStream stream;
+    stream.resize(capacity);
+    stream.request(1, startFrame);
+    REQUIRE( !stream.isReady(1) );
+
+    SndfileHandle file { path.string().c_str() };
+    file.seek(startFrame, SEEK_SET);
+    stream.open(std::move(file), 1, startFrame, endFrame);
+    REQUIRE( stream.isReady(1) );
+    REQUIRE( stream.getWrittenEnd() == startFrame );
+
+    auto frames = stream.getFrames();
+    auto ring = frames.getConstSpan(0);
+    constexpr int guard { sfz::FileStream::guardFrames };
+    for (int position = startFrame; position < endFrame + guard; position += 8) {
+        stream.setReadPosition(position);
+        // The ring never gets ahead of the read position by more than its capacity
+        while (stream.getFramesToWrite(capacity) > 0)
+            writeChunk(stream, capacity, 24);
+        REQUIRE( stream.getWrittenEnd() <= position + capacity );
+        for (int frame = position; frame < stream.getWrittenEnd(); ++frame) {
+            const auto value = expected[std::min(frame, endFrame - 1)];
+            const auto index = stream.getRingIndex(frame);
+            REQUIRE( ring[index] == value );
+            // The guards duplicate the other end of the ring
+            if (index < 2 * guard)
+                REQUIRE( ring[index + capacity] == value );
+            if (index >= capacity)
+                REQUIRE( ring[index - capacity] == value );
+        }
+    }
+    // Past the end of the streamed part, the last frame is repeated
+    REQUIRE( stream.getWrittenEnd() == endFrame + guard );
+
+    // A new request stops the stream from being served
+    stream.request(2, 0);
+    REQUIRE( !stream.isReady(2) );
+    REQUIRE( !stream.isRequested() );
+    stream.close();
+    REQUIRE( !stream.isOpen() );
+}
@@ -282,20 +282,24 @@ TEST_CASE("[Files] sw_default and playing with switches")
     REQUIRE( synth.getRegionView(1)->isSwitchedOn() );
     REQUIRE( !synth.getRegionView(2)->isSwitchedOn() );
     REQUIRE( synth.getRegionView(3)->isSwitchedOn() );
+    sfz::AudioBuffer<float> buffer { 2, 256 };
     synth.noteOn(0, 1, 41, 64);
     synth.noteOff(0, 1, 41, 0);
+    synth.renderBlock(buffer);
     REQUIRE( synth.getRegionView(0)->isSwitchedOn() );
     REQUIRE( !synth.getRegionView(1)->isSwitchedOn() );
     REQUIRE( synth.getRegionView(2)->isSwitchedOn() );
     REQUIRE( !synth.getRegionView(3)->isSwitchedOn() );
     synth.noteOn(0, 1, 42, 64);
     synth.noteOff(0, 1, 42, 0);
+    synth.renderBlock(buffer);
     REQUIRE( !synth.getRegionView(0)->isSwitchedOn() );
     REQUIRE( !synth.getRegionView(1)->isSwitchedOn() );
     REQUIRE( !synth.getRegionView(2)->isSwitchedOn() );
     REQUIRE( !synth.getRegionView(3)->isSwitchedOn() );
     synth.noteOn(0, 1, 40, 64);
     synth.noteOff(0, 1, 40, 64);
+    synth.renderBlock(buffer);
     REQUIRE( !synth.getRegionView(0)->isSwitchedOn() );
     REQUIRE( synth.getRegionView(1)->isSwitchedOn() );
     REQUIRE( !synth.getRegionView(2)->isSwitchedOn() );
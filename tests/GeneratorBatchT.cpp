@@ -0,0 +1,135 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "GeneratorBatch.h"
+#include "Voice.h"
+#include "Region.h"
+#include "MidiState.h"
+#include "AudioBuffer.h"
+#include "catch2/catch.hpp"
+#include <memory>
+#include <vector>
+using namespace Catch::literals;
+
+namespace {
+constexpr int quantum { 64 };
+
+struct VoiceSetup {
+    VoiceSetup(const sfz::MidiState& midiState)
+    : voice(midiState)
+    {
+        voice.setSamplesPerBlock(quantum);
+        voice.setScratchBuffers(absl::MakeSpan(scratch), absl::MakeSpan(indices));
+    }
+    sfz::Voice voice;
+    std::vector<float> scratch = std::vector<float>(sfz::Voice::numScratchBuffers * quantum);
+    std::vector<int> indices = std::vector<int>(quantum);
+};
+}
+
+TEST_CASE("[GeneratorBatch] Batchable voices")
+{
+    sfz::MidiState midiState;
+    VoiceSetup setup { midiState };
+    sfz::Region sine { midiState };
+    sine.parseOpcode({ "sample", "*sine" });
+    sfz::Region noise { midiState };
+    noise.parseOpcode({ "sample", "*noise" });
+    sfz::Region sample { midiState };
+    sample.parseOpcode({ "sample", "dummy.wav" });
+
+    REQUIRE( !setup.voice.isBatchable() );
+    setup.voice.startVoice(&sine, 0, 1, 60, 100, sfz::Voice::TriggerType::NoteOn);
+    REQUIRE( setup.voice.isBatchable() );
+    setup.voice.startVoice(&sine, 10, 1, 60, 100, sfz::Voice::TriggerType::NoteOn);
+    REQUIRE( !setup.voice.isBatchable() );
+    setup.voice.startVoice(&noise, 0, 1, 60, 100, sfz::Voice::TriggerType::NoteOn);
+    REQUIRE( !setup.voice.isBatchable() );
+    setup.voice.startVoice(&sample, 0, 1, 60, 100, sfz::Voice::TriggerType::NoteOn);
+    REQUIRE( !setup.voice.isBatchable() );
+}
+
+TEST_CASE("[GeneratorBatch] Batched voices render like single voices")
+{
+    sfz::MidiState midiState;
+    std::vector<std::unique_ptr<sfz::Region>> regions;
+    auto addRegion = [&](std::vector<sfz::Opcode> opcodes) {
+        regions.push_back(std::make_unique<sfz::Region>(midiState));
+        for (auto& opcode : opcodes)
+            regions.back()->parseOpcode(opcode);
+    };
+    addRegion({ { "sample", "*sine" } });
+    addRegion({ { "sample", "*saw" }, { "ampeg_attack", "0.002" }, { "width", "50" } });
+    addRegion({ { "sample", "*square" }, { "volume", "-6" }, { "ampeg_release", "0.001" } });
+    addRegion({ { "sample", "*triangle" }, { "amplitude", "50" }, { "pitch_keycenter", "48" } });
+    addRegion({ { "sample", "*sine" }, { "width", "-20" } });
+
+    std::vector<std::unique_ptr<VoiceSetup>> singleVoices;
+    std::vector<std::unique_ptr<VoiceSetup>> batchedSetups;
+    std::vector<sfz::Voice*> batchedVoices;
+    int note { 50 };
+    for (auto& region : regions) {
+        for (auto* setups : { &singleVoices, &batchedSetups }) {
+            setups->push_back(std::make_unique<VoiceSetup>(midiState));
+            setups->back()->voice.startVoice(region.get(), 0, 1, note, 90, sfz::Voice::TriggerType::NoteOn);
+        }
+        batchedVoices.push_back(&batchedSetups.back()->voice);
+        note += 7;
+    }
+
+    sfz::GeneratorBatch batch;
+    batch.setSamplesPerBlock(quantum);
+    batch.setNumVoices(static_cast<int>(batchedVoices.size()));
+    sfz::AudioBuffer<float> expected { 2, quantum };
+    sfz::AudioBuffer<float> output { 2, quantum };
+    for (int block = 0; block < 32; ++block) {
+        if (block == 16) {
+            for (auto& setup : singleVoices)
+                setup->voice.registerNoteOff(5, 1, setup->voice.getTriggerNumber(), 0);
+            for (auto* voice : batchedVoices)
+                voice->registerNoteOff(5, 1, voice->getTriggerNumber(), 0);
+        }
+
+        sfz::AudioSpan<float>(expected).fill(0.0f);
+        sfz::AudioSpan<float>(output).fill(0.0f);
+        for (auto& setup : singleVoices)
+            setup->voice.renderBlockAccumulate(expected);
+        std::vector<sfz::Voice*> playingVoices;
+        for (auto* voice : batchedVoices) {
+            if (voice->isBatchable())
+                playingVoices.push_back(voice);
+        }
+        batch.renderVoices(playingVoices, output);
+
+        for (int channel = 0; channel < 2; ++channel) {
+            for (int frame = 0; frame < quantum; ++frame)
+                REQUIRE( output.getSample(channel, frame) == Approx(expected.getSample(channel, frame)).margin(1e-5) );
+        }
+        for (size_t i = 0; i < batchedVoices.size(); ++i) {
+            REQUIRE( batchedVoices[i]->isFree() == singleVoices[i]->voice.isFree() );
+            if (!batchedVoices[i]->isFree())
+                REQUIRE( batchedVoices[i]->getMeanSquaredAverage() == Approx(singleVoices[i]->voice.getMeanSquaredAverage()).margin(1e-6) );
+        }
+    }
+    REQUIRE( batchedVoices[2]->isFree() );
+}
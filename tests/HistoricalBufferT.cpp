@@ -0,0 +1,87 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "HistoricalBuffer.h"
+#include "catch2/catch.hpp"
+#include <cmath>
+#include <deque>
+#include <numeric>
+#include <random>
+using namespace Catch::literals;
+
+TEST_CASE("[HistoricalBuffer] Average of the last values")
+{
+    sfz::HistoricalBuffer<float> buffer { 4 };
+    REQUIRE( buffer.getAverage() == 0.0f );
+    buffer.push(4.0f);
+    REQUIRE( buffer.getAverage() == 1.0_a );
+    buffer.push(4.0f);
+    buffer.push(4.0f);
+    buffer.push(4.0f);
+    REQUIRE( buffer.getAverage() == 4.0_a );
+    buffer.push(0.0f);
+    buffer.push(0.0f);
+    REQUIRE( buffer.getAverage() == 2.0_a );
+    buffer.reset();
+    REQUIRE( buffer.getAverage() == 0.0f );
+    buffer.push(8.0f);
+    REQUIRE( buffer.getAverage() == 2.0_a );
+}
+
+TEST_CASE("[HistoricalBuffer] Resize")
+{
+    sfz::HistoricalBuffer<float> buffer { 4 };
+    buffer.push(1.0f);
+    buffer.resize(2);
+    REQUIRE( buffer.getAverage() == 0.0f );
+    buffer.push(1.0f);
+    buffer.push(3.0f);
+    buffer.push(5.0f);
+    REQUIRE( buffer.getAverage() == 4.0_a );
+
+    sfz::HistoricalBuffer<float> empty { 0 };
+    empty.push(1.0f);
+    REQUIRE( empty.getAverage() == 0.0f );
+}
+
+TEST_CASE("[HistoricalBuffer] Running sum matches the full average")
+{
+    // Values spanning many orders of magnitude, as voice powers do
+    constexpr size_t size { 16 };
+    sfz::HistoricalBuffer<float> buffer { size };
+    std::deque<float> lastValues(size, 0.0f);
+    std::minstd_rand generator { 42 };
+    std::uniform_real_distribution<float> exponent { -12.0f, 0.0f };
+    for (int i = 0; i < 10000; ++i) {
+        const auto value = std::pow(10.0f, exponent(generator));
+        buffer.push(value);
+        lastValues.pop_front();
+        lastValues.push_back(value);
+        const auto expected = std::accumulate(lastValues.begin(), lastValues.end(), 0.0) / size;
+        REQUIRE( buffer.getAverage() == Approx(expected).epsilon(1e-3).margin(1e-6) );
+    }
+
+    for (size_t i = 0; i < size; ++i)
+        buffer.push(0.0f);
+    REQUIRE( buffer.getAverage() == 0.0f );
+}
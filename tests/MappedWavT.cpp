@@ -0,0 +1,114 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "MappedWav.h"
+#include "AudioBuffer.h"
+#include "catch2/catch.hpp"
+#include "../sfizz/ghc/fs_std.hpp"
+#include <sndfile.hh>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace {
+// Writes a WAV file with random data in the given format
+void writeRandomWave(const fs::path& path, int formatTag, int bitsPerSample, int numChannels, int numFrames)
+{
+    auto write = [](std::ofstream& stream, uint32_t value, int numBytes) {
+        for (int i = 0; i < numBytes; ++i)
+            stream.put(static_cast<char>((value >> (8 * i)) & 0xff));
+    };
+    const auto blockAlign = static_cast<uint32_t>(numChannels * bitsPerSample / 8);
+    const auto dataSize = blockAlign * numFrames;
+    std::ofstream stream { path.string(), std::ios::binary };
+    stream.write("RIFF", 4);
+    write(stream, 36 + dataSize, 4);
+    stream.write("WAVEfmt ", 8);
+    write(stream, 16, 4);
+    write(stream, formatTag, 2);
+    write(stream, numChannels, 2);
+    write(stream, 48000, 4);
+    write(stream, 48000 * blockAlign, 4);
+    write(stream, blockAlign, 2);
+    write(stream, bitsPerSample, 2);
+    stream.write("data", 4);
+    write(stream, dataSize, 4);
+    std::minstd_rand generator { 1 };
+    std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+    for (int i = 0; i < numFrames * numChannels; ++i) {
+        if (formatTag == 3) {
+            const auto value = distribution(generator);
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            write(stream, bits, 4);
+        } else {
+            write(stream, static_cast<uint32_t>(generator()), bitsPerSample / 8);
+        }
+    }
+}
+}
+
+TEST_CASE("[MappedWav] Mapped frames match libsndfile")
+{
+    const auto path = fs::temp_directory_path() / "sfizz_mapped.wav";
+    constexpr int numFrames { 1000 };
+    constexpr int startFrame { 300 };
+    for (const auto& format : { std::make_pair(1, 16), std::make_pair(1, 24), std::make_pair(1, 32), std::make_pair(3, 32) }) {
+        for (int numChannels : { 1, 2 }) {
+            writeRandomWave(path, format.first, format.second, numChannels, numFrames);
+            sfz::MappedWav mapping;
+            REQUIRE( mapping.open(path) );
+            REQUIRE( mapping.getNumChannels() == numChannels );
+            REQUIRE( mapping.getNumFrames() == numFrames );
+
+            SndfileHandle file { path.string().c_str() };
+            std::vector<float> expected(numFrames * numChannels);
+            file.readf(expected.data(), numFrames);
+
+            // Ask for more than the file holds, from the middle of the file
+            sfz::AudioBuffer<float> output { numChannels, numFrames };
+            const auto framesRead = mapping.read(startFrame, output);
+            REQUIRE( framesRead == numFrames - startFrame );
+            for (int channel = 0; channel < numChannels; ++channel) {
+                for (int frame = 0; frame < framesRead; ++frame)
+                    REQUIRE( output.getSample(channel, frame) == expected[(startFrame + frame) * numChannels + channel] );
+            }
+            mapping.willNeed(startFrame, numFrames);
+        }
+    }
+    fs::remove(path);
+}
+
+TEST_CASE("[MappedWav] Unsupported files are not mapped")
+{
+    const auto path = fs::temp_directory_path() / "sfizz_mapped.wav";
+    sfz::MappedWav mapping;
+    REQUIRE( !mapping.open(path / "missing.wav") );
+    // 8 bit PCM is left to libsndfile
+    writeRandomWave(path, 1, 8, 1, 100);
+    REQUIRE( !mapping.open(path) );
+    REQUIRE( !mapping.isOpen() );
+    fs::remove(path);
+}
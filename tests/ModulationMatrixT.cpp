@@ -0,0 +1,87 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "ModulationMatrix.h"
+#include "MathHelpers.h"
+#include "catch2/catch.hpp"
+#include <array>
+#include <vector>
+using namespace Catch::literals;
+
+TEST_CASE("[ModulationMatrix] Base values")
+{
+    sfz::MidiState midiState;
+    sfz::ModulationMatrix matrix { midiState };
+    matrix.setBaseValue(sfz::ModulationTarget::amplitude, 0.5f);
+    matrix.setBaseValue(sfz::ModulationTarget::volume, -6.0f);
+    matrix.setBaseValue(sfz::ModulationTarget::pan, 0.2f);
+    matrix.start({});
+    REQUIRE( matrix.getValue(sfz::ModulationTarget::amplitude) == 0.5f );
+    REQUIRE( matrix.getValue(sfz::ModulationTarget::volume) == Approx(db2mag(-6.0f)) );
+    REQUIRE( matrix.getValue(sfz::ModulationTarget::pan) == 0.2f );
+
+    std::array<float, 8> output;
+    output.fill(-1.0f);
+    matrix.evaluate();
+    REQUIRE( matrix.getBlockOrConstant(sfz::ModulationTarget::pan, absl::MakeSpan(output)) == 0.2f );
+    REQUIRE( output[0] == -1.0f );
+}
+
+TEST_CASE("[ModulationMatrix] CC routings")
+{
+    sfz::MidiState midiState;
+    midiState.cc.fill(0);
+    midiState.cc[10] = 127;
+    const std::vector<sfz::ModulationRouting> routings {
+        { sfz::ModulationSource::cc, 10, sfz::ModulationTarget::amplitude, 0.5f },
+        { sfz::ModulationSource::cc, 11, sfz::ModulationTarget::volume, -12.0f },
+        { sfz::ModulationSource::cc, 10, sfz::ModulationTarget::width, -0.5f },
+    };
+
+    sfz::ModulationMatrix matrix { midiState };
+    matrix.setBaseValue(sfz::ModulationTarget::amplitude, 1.0f);
+    matrix.setBaseValue(sfz::ModulationTarget::volume, 0.0f);
+    matrix.setBaseValue(sfz::ModulationTarget::width, 1.0f);
+    matrix.start(routings);
+    REQUIRE( matrix.getValue(sfz::ModulationTarget::amplitude) == 0.5f );
+    REQUIRE( matrix.getValue(sfz::ModulationTarget::volume) == 1.0f );
+    REQUIRE( matrix.getValue(sfz::ModulationTarget::width) == 0.5f );
+
+    // The volume CC only changes the volume target
+    midiState.cc[11] = 127;
+    matrix.evaluate();
+    REQUIRE( matrix.getValue(sfz::ModulationTarget::amplitude) == 0.5f );
+    REQUIRE( matrix.getValue(sfz::ModulationTarget::volume) == Approx(db2mag(-12.0f)) );
+
+    std::array<float, 4> output;
+    REQUIRE( matrix.getBlockOrConstant(sfz::ModulationTarget::amplitude, absl::MakeSpan(output)) == 0.5f );
+    REQUIRE( !matrix.getBlockOrConstant(sfz::ModulationTarget::volume, absl::MakeSpan(output)) );
+    const float step = (db2mag(-12.0f) - 1.0f) / 4;
+    REQUIRE( output[0] == Approx(1.0f + step) );
+    REQUIRE( output[1] == Approx(1.0f + 2 * step) );
+    REQUIRE( output[3] == Approx(db2mag(-12.0f)) );
+
+    // The ramp only lasts for a block
+    matrix.evaluate();
+    REQUIRE( matrix.getBlockOrConstant(sfz::ModulationTarget::volume, absl::MakeSpan(output)) == Approx(db2mag(-12.0f)) );
+}
@@ -157,6 +157,18 @@ TEST_CASE("[Region] Parsing opcodes")
         REQUIRE(region.loopRange == sfz::Range<uint32_t>(0, 4294967295));
     }
 
+    SECTION("sample_quality")
+    {
+        REQUIRE(!region.sampleQuality);
+        region.parseOpcode({ "sample_quality", "2" });
+        REQUIRE(region.sampleQuality);
+        REQUIRE(*region.sampleQuality == 2);
+        region.parseOpcode({ "sample_quality", "-1" });
+        REQUIRE(*region.sampleQuality == 0);
+        region.parseOpcode({ "sample_quality", "12" });
+        REQUIRE(*region.sampleQuality == 10);
+    }
+
     SECTION("group")
     {
         REQUIRE(region.group == 0);
@@ -493,6 +505,38 @@ TEST_CASE("[Region] Parsing opcodes")
         REQUIRE(region.pan == 100.0f);
     }
 
+    SECTION("volume_oncc")
+    {
+        REQUIRE(!region.volumeCC);
+        region.parseOpcode({ "volume_oncc45", "-4.2" });
+        REQUIRE(region.volumeCC);
+        REQUIRE(region.volumeCC->first == 45);
+        REQUIRE(region.volumeCC->second == -4.2f);
+        region.parseOpcode({ "volume_oncc45", "-200" });
+        REQUIRE(region.volumeCC->second == -144.0f);
+    }
+
+    SECTION("Modulation routings")
+    {
+        region.compileModulations();
+        REQUIRE(region.modulations.empty());
+        region.parseOpcode({ "amplitude_oncc10", "50" });
+        region.parseOpcode({ "volume_oncc11", "-6" });
+        region.parseOpcode({ "pan_oncc12", "-150" });
+        region.compileModulations();
+        REQUIRE(region.modulations.size() == 3);
+        REQUIRE(region.modulations[0].source == sfz::ModulationSource::cc);
+        REQUIRE(region.modulations[0].ccNumber == 10);
+        REQUIRE(region.modulations[0].target == sfz::ModulationTarget::amplitude);
+        REQUIRE(region.modulations[0].depth == 0.5f);
+        REQUIRE(region.modulations[1].ccNumber == 11);
+        REQUIRE(region.modulations[1].target == sfz::ModulationTarget::volume);
+        REQUIRE(region.modulations[1].depth == -6.0f);
+        REQUIRE(region.modulations[2].ccNumber == 12);
+        REQUIRE(region.modulations[2].target == sfz::ModulationTarget::pan);
+        REQUIRE(region.modulations[2].depth == -1.0f);
+    }
+
     SECTION("pan_oncc")
     {
         REQUIRE(!region.panCC);
@@ -27,6 +27,8 @@
 #include <absl/types/span.h>
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <numeric>
 #include <iostream>
 using namespace Catch::literals;
 
@@ -442,6 +444,28 @@ TEST_CASE("[Helpers] SFZ looping index (SIMD)")
     REQUIRE(approxEqual<float>(rightCoeffs, expectedRight));
 }
 
+TEST_CASE("[Helpers] SFZ looping index, multiple wraps per sample")
+{
+    std::array<float, 8> jumps { 7.25f, 7.25f, 7.25f, 7.25f, 7.25f, 7.25f, 7.25f, 7.25f };
+    std::array<int, 8> indices;
+    std::array<float, 8> leftCoeffs;
+    std::array<float, 8> rightCoeffs;
+    std::array<int, 8> indicesSIMD;
+    std::array<float, 8> leftCoeffsSIMD;
+    std::array<float, 8> rightCoeffsSIMD;
+    // Loop is [1, 4[ so positions are 1 + (1 + 7.25 k - 1) mod 3
+    std::array<int, 8> expectedIndices { 2, 3, 1, 3, 1, 2, 3, 2 };
+    std::array<float, 8> expectedRight { 0.25f, 0.5f, 0.75f, 0.0f, 0.25f, 0.5f, 0.75f, 0.0f };
+    auto floatIndex = sfz::loopingSFZIndex<float, false>(jumps, absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), 1.0f, 4, 1);
+    REQUIRE(indices == expectedIndices);
+    REQUIRE(approxEqualMargin<float>(rightCoeffs, expectedRight));
+    REQUIRE(floatIndex == Approx(2.0f));
+    floatIndex = sfz::loopingSFZIndex<float, true>(jumps, absl::MakeSpan(leftCoeffsSIMD), absl::MakeSpan(rightCoeffsSIMD), absl::MakeSpan(indicesSIMD), 1.0f, 4, 1);
+    REQUIRE(indicesSIMD == expectedIndices);
+    REQUIRE(approxEqualMargin<float>(rightCoeffsSIMD, expectedRight));
+    REQUIRE(floatIndex == Approx(2.0f));
+}
+
 // TEST_CASE("[Helpers] SFZ looping index (SIMD vs Scalar)")
 // {
 
@@ -492,6 +516,20 @@ TEST_CASE("[Helpers] SFZ saturating index (SIMD)")
     REQUIRE(approxEqualMargin<float>(rightCoeffs, expectedRight));
 }
 
+TEST_CASE("[Helpers] SFZ saturating index, far from the origin (SIMD)")
+{
+    std::array<float, 8> jumps { 1.5f, 1.5f, 1.5f, 1.5f, 1.5f, 1.5f, 1.5f, 1.5f };
+    std::array<int, 8> indices;
+    std::array<float, 8> leftCoeffs;
+    std::array<float, 8> rightCoeffs;
+    std::array<int, 8> expectedIndices { 1001, 1003, 1004, 1006, 1007, 1007, 1007, 1007 };
+    std::array<float, 8> expectedRight { 0.5f, 0.0f, 0.5f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f };
+    const auto floatIndex = sfz::saturatingSFZIndex<float, true>(jumps, absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), 1000.0f, 1008);
+    REQUIRE(indices == expectedIndices);
+    REQUIRE(approxEqualMargin<float>(rightCoeffs, expectedRight));
+    REQUIRE(floatIndex == 1008.0f);
+}
+
 TEST_CASE("[Helpers] SFZ saturating index (SIMD vs Scalar)")
 {
 
@@ -511,6 +549,105 @@ TEST_CASE("[Helpers] SFZ saturating index (SIMD vs Scalar)")
         REQUIRE( static_cast<float>(indices[i]) + rightCoeffs[i] == Approx(static_cast<float>(indicesSIMD[i]) + rightCoeffsSIMD[i]));
 }
 
+TEST_CASE("[Helpers] Fixed point index (SIMD vs scalar)")
+{
+    std::vector<int> indices(bigBufferSize);
+    std::vector<float> leftCoeffs(bigBufferSize);
+    std::vector<float> rightCoeffs(bigBufferSize);
+    std::vector<int> indicesSIMD(bigBufferSize);
+    std::vector<float> leftCoeffsSIMD(bigBufferSize);
+    std::vector<float> rightCoeffsSIMD(bigBufferSize);
+    const auto start = sfz::toFixedPoint(12.34);
+    const auto step = sfz::toFixedPoint(fillValue);
+    const auto end = sfz::fixedPointIndex<float, false>(absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), start, step);
+    const auto endSIMD = sfz::fixedPointIndex<float, true>(absl::MakeSpan(leftCoeffsSIMD), absl::MakeSpan(rightCoeffsSIMD), absl::MakeSpan(indicesSIMD), start, step);
+    REQUIRE(end == start + bigBufferSize * step);
+    REQUIRE(endSIMD == end);
+    REQUIRE(indices == indicesSIMD);
+    REQUIRE(leftCoeffs == leftCoeffsSIMD);
+    REQUIRE(rightCoeffs == rightCoeffsSIMD);
+}
+
+TEST_CASE("[Helpers] Fixed point index (vs float index)")
+{
+    // With a step exactly representable in float both paths are exact
+    std::vector<float> jumps(bigBufferSize);
+    absl::c_fill(jumps, 1.25f);
+    std::vector<int> indices(bigBufferSize);
+    std::vector<float> leftCoeffs(bigBufferSize);
+    std::vector<float> rightCoeffs(bigBufferSize);
+    std::vector<int> indicesFixed(bigBufferSize);
+    std::vector<float> leftCoeffsFixed(bigBufferSize);
+    std::vector<float> rightCoeffsFixed(bigBufferSize);
+    const auto floatIndex = sfz::saturatingSFZIndex<float>(jumps, absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), 0.5f, 4000);
+    const auto fixedIndex = sfz::saturatingFixedPointIndex<float>(absl::MakeSpan(leftCoeffsFixed), absl::MakeSpan(rightCoeffsFixed), absl::MakeSpan(indicesFixed),
+        sfz::toFixedPoint(0.5f), sfz::toFixedPoint(1.25f), sfz::toFixedPoint(4000));
+    REQUIRE(fixedIndex == sfz::toFixedPoint(floatIndex));
+    REQUIRE(indices == indicesFixed);
+    REQUIRE(leftCoeffs == leftCoeffsFixed);
+    REQUIRE(rightCoeffs == rightCoeffsFixed);
+
+    const auto loopIndex = sfz::loopingSFZIndex<float>(jumps, absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), 0.5f, 1000, 100);
+    const auto loopFixedIndex = sfz::loopingFixedPointIndex<float>(absl::MakeSpan(leftCoeffsFixed), absl::MakeSpan(rightCoeffsFixed), absl::MakeSpan(indicesFixed),
+        sfz::toFixedPoint(0.5f), sfz::toFixedPoint(1.25f), sfz::toFixedPoint(1000), sfz::toFixedPoint(100));
+    REQUIRE(loopFixedIndex == sfz::toFixedPoint(loopIndex));
+    REQUIRE(indices == indicesFixed);
+    REQUIRE(leftCoeffs == leftCoeffsFixed);
+    REQUIRE(rightCoeffs == rightCoeffsFixed);
+}
+
+TEST_CASE("[Helpers] Fixed point index does not drift")
+{
+    // Play about 30 seconds by blocks with an odd pitch ratio
+    constexpr int numBlocks { 5000 };
+    constexpr double ratio { 1.0594630943592953 };
+    std::vector<int> indices(medBufferSize + 1);
+    std::vector<float> leftCoeffs(medBufferSize + 1);
+    std::vector<float> rightCoeffs(medBufferSize + 1);
+    const auto step = sfz::toFixedPoint(ratio);
+    uint64_t position { 0 };
+    for (int block = 0; block < numBlocks; ++block)
+        position = sfz::fixedPointIndex<float>(absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), position, step);
+
+    const double numFrames = static_cast<double>(numBlocks) * (medBufferSize + 1);
+    const double expected = numFrames * ratio;
+    REQUIRE(indices.back() == static_cast<int>(expected));
+    REQUIRE(static_cast<double>(position) / sfz::fixedPointOne == Approx(expected).margin(1e-4));
+}
+
+TEST_CASE("[Helpers] Fixed point saturating index")
+{
+    std::array<int, 8> indices;
+    std::array<float, 8> leftCoeffs;
+    std::array<float, 8> rightCoeffs;
+    std::array<int, 8> expectedIndices { 1001, 1003, 1004, 1006, 1007, 1007, 1007, 1007 };
+    std::array<float, 8> expectedRight { 0.5f, 0.0f, 0.5f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f };
+    const auto end = sfz::toFixedPoint(1008);
+    for (bool simd : { false, true }) {
+        const auto position = simd ?
+            sfz::saturatingFixedPointIndex<float, true>(absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), sfz::toFixedPoint(1000), sfz::toFixedPoint(1.5), end) :
+            sfz::saturatingFixedPointIndex<float, false>(absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), sfz::toFixedPoint(1000), sfz::toFixedPoint(1.5), end);
+        REQUIRE(indices == expectedIndices);
+        REQUIRE(rightCoeffs == expectedRight);
+        REQUIRE(position == end);
+    }
+}
+
+TEST_CASE("[Helpers] Fixed point looping index, multiple wraps per sample")
+{
+    std::array<int, 8> indices;
+    std::array<float, 8> leftCoeffs;
+    std::array<float, 8> rightCoeffs;
+    // Loop is [1, 4[ so positions are 1 + (1 + 7.25 k - 1) mod 3
+    std::array<int, 8> expectedIndices { 2, 3, 1, 3, 1, 2, 3, 2 };
+    std::array<float, 8> expectedRight { 0.25f, 0.5f, 0.75f, 0.0f, 0.25f, 0.5f, 0.75f, 0.0f };
+    const auto position = sfz::loopingFixedPointIndex<float>(absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices),
+        sfz::toFixedPoint(1), sfz::toFixedPoint(7.25), sfz::toFixedPoint(4), sfz::toFixedPoint(1));
+    REQUIRE(indices == expectedIndices);
+    REQUIRE(rightCoeffs == expectedRight);
+    REQUIRE(position == sfz::toFixedPoint(2));
+}
+
 TEST_CASE("[Helpers] Linear Ramp")
 {
     const float start { 0.0f };
@@ -706,6 +843,201 @@ TEST_CASE("[Helpers] copy (SIMD vs scalar)")
     REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
 }
 
+TEST_CASE("[Helpers] Linear interpolation")
+{
+    std::array<float, 6> source { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+    std::array<int, 5> indices { 0, 1, 1, 3, 4 };
+    std::array<float, 5> leftCoeffs { 1.0f, 0.5f, 0.25f, 0.0f, 0.9f };
+    std::array<float, 5> rightCoeffs { 0.0f, 0.5f, 0.75f, 1.0f, 0.1f };
+    std::array<float, 5> output;
+    std::array<float, 5> expected { 0.0f, 1.5f, 1.75f, 4.0f, 4.1f };
+    sfz::linearInterpolation<float, false>(source, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+    sfz::linearInterpolation<float, true>(source, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+}
+
+TEST_CASE("[Helpers] Linear interpolation (SIMD vs scalar)")
+{
+    std::vector<float> jumps(bigBufferSize);
+    std::vector<int> indices(bigBufferSize);
+    std::vector<float> leftCoeffs(bigBufferSize);
+    std::vector<float> rightCoeffs(bigBufferSize);
+    std::vector<float> sourceLeft(2 * bigBufferSize);
+    std::vector<float> sourceRight(2 * bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(sourceLeft), 0.0f, 0.1f);
+    sfz::linearRamp<float>(absl::MakeSpan(sourceRight), 1.0f, -0.1f);
+    absl::c_fill(jumps, fillValue);
+    sfz::saturatingSFZIndex<float, false>(jumps, absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), 0.0f, 2 * bigBufferSize - 1);
+
+    std::vector<float> outputScalar(bigBufferSize);
+    std::vector<float> outputSIMD(bigBufferSize);
+    sfz::linearInterpolation<float, false>(sourceLeft, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(outputScalar));
+    sfz::linearInterpolation<float, true>(sourceLeft, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(outputSIMD));
+    REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
+
+    std::vector<float> rightScalar(bigBufferSize);
+    std::vector<float> rightSIMD(bigBufferSize);
+    sfz::linearInterpolation<float, false>(sourceLeft, sourceRight, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(outputScalar), absl::MakeSpan(rightScalar));
+    sfz::linearInterpolation<float, true>(sourceLeft, sourceRight, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(outputSIMD), absl::MakeSpan(rightSIMD));
+    REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
+    REQUIRE(approxEqual<float>(rightScalar, rightSIMD));
+}
+
+TEST_CASE("[Helpers] Wavetable batch (vs looping index)")
+{
+    // A single oscillator with a unit gain reads the table like a loop would
+    constexpr int tableSize { 256 };
+    std::vector<float> table(tableSize + 1);
+    sfz::linearRamp<float>(absl::MakeSpan(table), -1.0f, 2.0f / tableSize);
+    table[tableSize] = table[0];
+    const auto step = sfz::toFixedPoint(3.7f);
+
+    std::vector<int> indices(medBufferSize);
+    std::vector<float> leftCoeffs(medBufferSize);
+    std::vector<float> rightCoeffs(medBufferSize);
+    std::vector<float> expected(medBufferSize);
+    const auto expectedPosition = sfz::loopingFixedPointIndex<float>(absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices),
+        0, step, sfz::toFixedPoint(tableSize), 0);
+    sfz::linearInterpolation<float>(table, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(expected));
+
+    std::vector<float> gain(medBufferSize);
+    absl::c_fill(gain, 1.0f);
+    for (bool simd : { false, true }) {
+        std::array<const float*, 1> tables { table.data() };
+        std::array<uint64_t, 1> positions { 0 };
+        std::array<uint64_t, 1> steps { step };
+        std::array<const float*, 1> gains { gain.data() };
+        std::array<float, 1> powers { 0.0f };
+        std::vector<float> output(medBufferSize);
+        if (simd)
+            sfz::wavetableBatch<float, true>(tables, absl::MakeSpan(positions), steps, gains, absl::MakeSpan(powers), absl::MakeSpan(output), tableSize);
+        else
+            sfz::wavetableBatch<float, false>(tables, absl::MakeSpan(positions), steps, gains, absl::MakeSpan(powers), absl::MakeSpan(output), tableSize);
+        REQUIRE(positions[0] == expectedPosition);
+        REQUIRE(approxEqual<float>(output, expected));
+        REQUIRE(powers[0] == Approx(std::inner_product(expected.begin(), expected.end(), expected.begin(), 0.0f)));
+    }
+}
+
+TEST_CASE("[Helpers] Wavetable batch (SIMD vs scalar)")
+{
+    // An odd number of voices and frames exercises the scalar tails
+    constexpr int tableSize { 1024 };
+    constexpr int numVoices { 11 };
+    std::vector<float> table(tableSize + 1);
+    for (int i = 0; i <= tableSize; ++i)
+        table[i] = std::sin(2.0f * static_cast<float>(M_PI) * i / tableSize);
+
+    std::vector<std::vector<float>> gainBuffers(numVoices, std::vector<float>(medBufferSize));
+    std::vector<const float*> tables(numVoices, table.data());
+    std::vector<const float*> gains;
+    std::vector<uint64_t> positions;
+    std::vector<uint64_t> steps;
+    for (int voice = 0; voice < numVoices; ++voice) {
+        sfz::linearRamp<float>(absl::MakeSpan(gainBuffers[voice]), 0.1f * voice, 0.01f);
+        gains.push_back(gainBuffers[voice].data());
+        positions.push_back(sfz::toFixedPoint(13.1f * voice));
+        steps.push_back(sfz::toFixedPoint(0.37f + 17.3f * voice));
+    }
+
+    auto positionsScalar = positions;
+    auto positionsSIMD = positions;
+    std::vector<float> powersScalar(numVoices);
+    std::vector<float> powersSIMD(numVoices);
+    std::vector<float> outputScalar(medBufferSize);
+    std::vector<float> outputSIMD(medBufferSize);
+    absl::c_fill(outputScalar, 0.5f);
+    absl::c_fill(outputSIMD, 0.5f);
+    sfz::wavetableBatch<float, false>(tables, absl::MakeSpan(positionsScalar), steps, gains, absl::MakeSpan(powersScalar), absl::MakeSpan(outputScalar), tableSize);
+    sfz::wavetableBatch<float, true>(tables, absl::MakeSpan(positionsSIMD), steps, gains, absl::MakeSpan(powersSIMD), absl::MakeSpan(outputSIMD), tableSize);
+    REQUIRE(positionsScalar == positionsSIMD);
+    REQUIRE(approxEqualMargin<float>(outputScalar, outputSIMD));
+    REQUIRE(approxEqual<float>(powersScalar, powersSIMD));
+}
+
+TEST_CASE("[Helpers] Hermite interpolation")
+{
+    std::array<float, 10> source { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f };
+    std::array<int, 5> indices { 0, 1, 2, 5, 8 };
+    std::array<float, 5> coeffs { 0.0f, 0.5f, 0.25f, 1.0f, 0.0f };
+    std::array<float, 5> output;
+    std::array<float, 5> expected { 0.0f, 1.5f, 2.25f, 6.0f, 8.0f };
+    sfz::hermiteInterpolation<float, false>(source, indices, coeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+    sfz::hermiteInterpolation<float, true>(source, indices, coeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+}
+
+TEST_CASE("[Helpers] Hermite interpolation (SIMD vs scalar)")
+{
+    std::vector<float> jumps(bigBufferSize);
+    std::vector<int> indices(bigBufferSize);
+    std::vector<float> leftCoeffs(bigBufferSize);
+    std::vector<float> rightCoeffs(bigBufferSize);
+    std::vector<float> source(2 * bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(source), 0.0f, 0.1f);
+    absl::c_fill(jumps, fillValue);
+    sfz::saturatingSFZIndex<float, false>(jumps, absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), 0.0f, 2 * bigBufferSize - 1);
+
+    std::vector<float> outputScalar(bigBufferSize);
+    std::vector<float> outputSIMD(bigBufferSize);
+    sfz::hermiteInterpolation<float, false>(source, indices, rightCoeffs, absl::MakeSpan(outputScalar));
+    sfz::hermiteInterpolation<float, true>(source, indices, rightCoeffs, absl::MakeSpan(outputSIMD));
+    REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
+}
+
+TEST_CASE("[Helpers] Sinc interpolation")
+{
+    std::array<float, 32> source;
+    absl::c_iota(source, 0.0f);
+    std::array<int, 4> indices { 8, 10, 13, 15 };
+    std::array<float, 4> coeffs { 0.0f, 0.5f, 0.0f, 1.0f };
+    std::array<float, 4> output;
+    std::array<float, 4> expected { 8.0f, 10.5f, 13.0f, 16.0f };
+    for (int taps : { 8, 16 }) {
+        sfz::sincInterpolation<float, false>(source, indices, coeffs, absl::MakeSpan(output), taps);
+        REQUIRE(approxEqual<float>(output, expected));
+        sfz::sincInterpolation<float, true>(source, indices, coeffs, absl::MakeSpan(output), taps);
+        REQUIRE(approxEqual<float>(output, expected));
+    }
+}
+
+TEST_CASE("[Helpers] Sinc interpolation at the source edges")
+{
+    std::array<float, 4> source { 1.0f, 1.0f, 1.0f, 1.0f };
+    std::array<int, 4> indices { 0, 1, 2, 3 };
+    std::array<float, 4> coeffs { 0.0f, 0.3f, 0.7f, 1.0f };
+    std::array<float, 4> output;
+    std::array<float, 4> expected { 1.0f, 1.0f, 1.0f, 1.0f };
+    for (int taps : { 8, 16 }) {
+        sfz::sincInterpolation<float, false>(source, indices, coeffs, absl::MakeSpan(output), taps);
+        REQUIRE(approxEqual<float>(output, expected));
+        sfz::sincInterpolation<float, true>(source, indices, coeffs, absl::MakeSpan(output), taps);
+        REQUIRE(approxEqual<float>(output, expected));
+    }
+}
+
+TEST_CASE("[Helpers] Sinc interpolation (SIMD vs scalar)")
+{
+    std::vector<float> jumps(bigBufferSize);
+    std::vector<int> indices(bigBufferSize);
+    std::vector<float> leftCoeffs(bigBufferSize);
+    std::vector<float> rightCoeffs(bigBufferSize);
+    std::vector<float> source(2 * bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(source), 0.0f, 0.1f);
+    absl::c_fill(jumps, fillValue);
+    sfz::saturatingSFZIndex<float, false>(jumps, absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs), absl::MakeSpan(indices), 0.0f, 2 * bigBufferSize - 1);
+
+    std::vector<float> outputScalar(bigBufferSize);
+    std::vector<float> outputSIMD(bigBufferSize);
+    for (int taps : { 8, 16 }) {
+        sfz::sincInterpolation<float, false>(source, indices, rightCoeffs, absl::MakeSpan(outputScalar), taps);
+        sfz::sincInterpolation<float, true>(source, indices, rightCoeffs, absl::MakeSpan(outputSIMD), taps);
+        REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
+    }
+}
+
 TEST_CASE("[Helpers] Mean")
 {
     std::array<float, 10> input { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f };
@@ -734,6 +1066,163 @@ TEST_CASE("[Helpers] Mean Squared (SIMD vs scalar)")
     REQUIRE(sfz::meanSquared<float, false>(input) == sfz::meanSquared<float, true>(input));
 }
 
+TEST_CASE("[Helpers] Pan law")
+{
+    std::array<float, 5> pan { -1.0f, 0.0f, 1.0f, -2.0f, 2.0f };
+    std::array<float, 5> cosOutput;
+    std::array<float, 5> sinOutput;
+    std::array<float, 5> expectedCos { 1.0f, sqrtTwoInv<float>, 0.0f, 1.0f, 0.0f };
+    std::array<float, 5> expectedSin { 0.0f, sqrtTwoInv<float>, 1.0f, 0.0f, 1.0f };
+    sfz::panLaw<float, false>(pan, absl::MakeSpan(cosOutput), absl::MakeSpan(sinOutput));
+    REQUIRE(approxEqualMargin<float>(cosOutput, expectedCos, 1e-6f));
+    REQUIRE(approxEqualMargin<float>(sinOutput, expectedSin, 1e-6f));
+    sfz::panLaw<float, true>(pan, absl::MakeSpan(cosOutput), absl::MakeSpan(sinOutput));
+    REQUIRE(approxEqualMargin<float>(cosOutput, expectedCos, 1e-6f));
+    REQUIRE(approxEqualMargin<float>(sinOutput, expectedSin, 1e-6f));
+}
+
+TEST_CASE("[Helpers] Pan law (SIMD vs scalar)")
+{
+    std::vector<float> pan(bigBufferSize);
+    std::vector<float> cosScalar(bigBufferSize);
+    std::vector<float> sinScalar(bigBufferSize);
+    std::vector<float> cosSIMD(bigBufferSize);
+    std::vector<float> sinSIMD(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(pan), -1.2f, 2.4f / bigBufferSize);
+    sfz::panLaw<float, false>(pan, absl::MakeSpan(cosScalar), absl::MakeSpan(sinScalar));
+    sfz::panLaw<float, true>(pan, absl::MakeSpan(cosSIMD), absl::MakeSpan(sinSIMD));
+    REQUIRE(approxEqualMargin<float>(cosScalar, cosSIMD, 1e-6f));
+    REQUIRE(approxEqualMargin<float>(sinScalar, sinSIMD, 1e-6f));
+}
+
+TEST_CASE("[Helpers] Pan law in place (SIMD vs scalar)")
+{
+    std::vector<float> panScalar(bigBufferSize);
+    std::vector<float> panSIMD(bigBufferSize);
+    std::vector<float> cosScalar(bigBufferSize);
+    std::vector<float> cosSIMD(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(panScalar), -1.0f, 2.0f / bigBufferSize);
+    sfz::copy<float>(panScalar, absl::MakeSpan(panSIMD));
+    sfz::panLaw<float, false>(panScalar, absl::MakeSpan(cosScalar), absl::MakeSpan(panScalar));
+    sfz::panLaw<float, true>(panSIMD, absl::MakeSpan(cosSIMD), absl::MakeSpan(panSIMD));
+    REQUIRE(approxEqualMargin<float>(cosScalar, cosSIMD, 1e-6f));
+    REQUIRE(approxEqualMargin<float>(panScalar, panSIMD, 1e-6f));
+}
+
+TEST_CASE("[Helpers] Pan (SIMD vs scalar)")
+{
+    std::vector<float> pan(bigBufferSize);
+    std::vector<float> leftScalar(bigBufferSize);
+    std::vector<float> rightScalar(bigBufferSize);
+    std::vector<float> leftSIMD(bigBufferSize);
+    std::vector<float> rightSIMD(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(pan), -1.0f, 2.0f / bigBufferSize);
+    absl::c_fill(leftScalar, 1.0f);
+    absl::c_fill(rightScalar, 0.5f);
+    absl::c_fill(leftSIMD, 1.0f);
+    absl::c_fill(rightSIMD, 0.5f);
+    sfz::pan<float, false>(pan, absl::MakeSpan(leftScalar), absl::MakeSpan(rightScalar));
+    sfz::pan<float, true>(pan, absl::MakeSpan(leftSIMD), absl::MakeSpan(rightSIMD));
+    REQUIRE(approxEqualMargin<float>(leftScalar, leftSIMD, 1e-6f));
+    REQUIRE(approxEqualMargin<float>(rightScalar, rightSIMD, 1e-6f));
+}
+
+TEST_CASE("[Helpers] Mono mix")
+{
+    std::array<float, 3> gain { 1.0f, 2.0f, 0.5f };
+    std::array<float, 3> panCos { 1.0f, 0.0f, 0.5f };
+    std::array<float, 3> panSin { 0.0f, 1.0f, 0.5f };
+    std::array<float, 3> input { 1.0f, 1.0f, 2.0f };
+    std::array<float, 3> left { 1.0f, 1.0f, 1.0f };
+    std::array<float, 3> right { 1.0f, 1.0f, 1.0f };
+    std::array<float, 3> expectedLeft { 2.0f, 1.0f, 1.5f };
+    std::array<float, 3> expectedRight { 1.0f, 3.0f, 1.5f };
+    const auto power = sfz::monoMix<float, false>(gain, panCos, panSin, input, absl::MakeSpan(left), absl::MakeSpan(right));
+    REQUIRE(left == expectedLeft);
+    REQUIRE(right == expectedRight);
+    REQUIRE(power == Approx(5.5f / 6.0f));
+}
+
+TEST_CASE("[Helpers] Mono mix (SIMD vs scalar)")
+{
+    std::vector<float> gain(bigBufferSize);
+    std::vector<float> panCos(bigBufferSize);
+    std::vector<float> panSin(bigBufferSize);
+    std::vector<float> input(bigBufferSize);
+    std::vector<float> leftScalar(bigBufferSize);
+    std::vector<float> rightScalar(bigBufferSize);
+    std::vector<float> leftSIMD(bigBufferSize);
+    std::vector<float> rightSIMD(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(gain), 0.0f, 1.0f / bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(panCos), 1.0f, -1.0f / bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(panSin), 0.0f, 1.0f / bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(input), -1.0f, 2.0f / bigBufferSize);
+    absl::c_fill(leftScalar, 0.5f);
+    absl::c_fill(rightScalar, -0.5f);
+    absl::c_fill(leftSIMD, 0.5f);
+    absl::c_fill(rightSIMD, -0.5f);
+
+    const auto powerScalar = sfz::monoMix<float, false>(gain, panCos, panSin, input, absl::MakeSpan(leftScalar), absl::MakeSpan(rightScalar));
+    const auto powerSIMD = sfz::monoMix<float, true>(gain, panCos, panSin, input, absl::MakeSpan(leftSIMD), absl::MakeSpan(rightSIMD));
+    REQUIRE(approxEqual<float>(leftScalar, leftSIMD));
+    REQUIRE(approxEqual<float>(rightScalar, rightSIMD));
+    REQUIRE(powerScalar == Approx(powerSIMD));
+}
+
+TEST_CASE("[Helpers] Stereo mix")
+{
+    std::array<float, 2> gain { 1.0f, 2.0f };
+    std::array<float, 2> widthCos { 0.0f, 1.0f };
+    std::array<float, 2> widthSin { 1.0f, 0.0f };
+    std::array<float, 2> positionCos { 1.0f, 1.0f };
+    std::array<float, 2> positionSin { 0.0f, 0.0f };
+    std::array<float, 2> inputLeft { 1.0f, 3.0f };
+    std::array<float, 2> inputRight { 1.0f, 1.0f };
+    std::array<float, 2> left { 0.0f, 0.0f };
+    std::array<float, 2> right { 0.0f, 0.0f };
+    std::array<float, 2> expectedLeft { 1.0f, 2.0f };
+    std::array<float, 2> expectedRight { 1.0f, 0.0f };
+    const auto power = sfz::stereoMix<float, false>(gain, widthCos, widthSin, positionCos, positionSin,
+        inputLeft, inputRight, absl::MakeSpan(left), absl::MakeSpan(right));
+    REQUIRE(left == expectedLeft);
+    REQUIRE(right == expectedRight);
+    REQUIRE(power == 1.5f);
+}
+
+TEST_CASE("[Helpers] Stereo mix (SIMD vs scalar)")
+{
+    std::vector<float> gain(bigBufferSize);
+    std::vector<float> widthCos(bigBufferSize);
+    std::vector<float> widthSin(bigBufferSize);
+    std::vector<float> positionCos(bigBufferSize);
+    std::vector<float> positionSin(bigBufferSize);
+    std::vector<float> inputLeft(bigBufferSize);
+    std::vector<float> inputRight(bigBufferSize);
+    std::vector<float> leftScalar(bigBufferSize);
+    std::vector<float> rightScalar(bigBufferSize);
+    std::vector<float> leftSIMD(bigBufferSize);
+    std::vector<float> rightSIMD(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(gain), 0.0f, 1.0f / bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(widthCos), 1.0f, -1.0f / bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(widthSin), 0.0f, 1.0f / bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(positionCos), 0.0f, 1.0f / bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(positionSin), 1.0f, -1.0f / bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(inputLeft), -1.0f, 2.0f / bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(inputRight), 1.0f, -1.0f / bigBufferSize);
+    absl::c_fill(leftScalar, 0.5f);
+    absl::c_fill(rightScalar, -0.5f);
+    absl::c_fill(leftSIMD, 0.5f);
+    absl::c_fill(rightSIMD, -0.5f);
+
+    const auto powerScalar = sfz::stereoMix<float, false>(gain, widthCos, widthSin, positionCos, positionSin,
+        inputLeft, inputRight, absl::MakeSpan(leftScalar), absl::MakeSpan(rightScalar));
+    const auto powerSIMD = sfz::stereoMix<float, true>(gain, widthCos, widthSin, positionCos, positionSin,
+        inputLeft, inputRight, absl::MakeSpan(leftSIMD), absl::MakeSpan(rightSIMD));
+    REQUIRE(approxEqual<float>(leftScalar, leftSIMD));
+    REQUIRE(approxEqual<float>(rightScalar, rightSIMD));
+    REQUIRE(powerScalar == Approx(powerSIMD));
+}
+
 TEST_CASE("[Helpers] Cumulative sum ")
 {
     std::array<float, 6> input { 1.1f, 1.2f, 1.3f, 1.4f, 1.5f, 1.6f }; // 1.1 2.3 3.6 5.0 6.5 8.1
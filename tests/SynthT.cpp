@@ -0,0 +1,577 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Synth.h"
+#include "TestHelpers.h"
+#include "catch2/catch.hpp"
+#include "../sfizz/ghc/fs_std.hpp"
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <vector>
+using namespace Catch::literals;
+
+namespace {
+constexpr int blockSize { 256 };
+constexpr int numBlocks { 16 };
+
+std::vector<float> renderNotes(sfz::Synth& synth)
+{
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/sine_and_kick.sfz");
+    for (int note = 48; note < 72; ++note)
+        synth.noteOn(note % 7, 1, note, 100);
+
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+    std::vector<float> output;
+    for (int block = 0; block < numBlocks; ++block) {
+        synth.renderBlock(buffer);
+        output.insert(output.end(), buffer.channelReader(0), buffer.channelReaderEnd(0));
+        output.insert(output.end(), buffer.channelReader(1), buffer.channelReaderEnd(1));
+    }
+    return output;
+}
+}
+
+TEST_CASE("[Synth] Multithreaded rendering")
+{
+    sfz::Synth serialSynth;
+    const auto serialOutput = renderNotes(serialSynth);
+
+    sfz::Synth threadedSynth;
+    threadedSynth.setNumThreads(4);
+    REQUIRE( threadedSynth.getNumThreads() == 4 );
+    const auto threadedOutput = renderNotes(threadedSynth);
+
+    REQUIRE( serialOutput.size() == threadedOutput.size() );
+    for (size_t i = 0; i < serialOutput.size(); ++i)
+        REQUIRE( threadedOutput[i] == Approx(serialOutput[i]).margin(1e-5) );
+}
+
+TEST_CASE("[Synth] Deterministic multithreaded rendering")
+{
+    sfz::Synth serialSynth;
+    serialSynth.setDeterministicRendering(true);
+    const auto serialOutput = renderNotes(serialSynth);
+    REQUIRE( std::any_of(serialOutput.begin(), serialOutput.end(), [](float value) { return value != 0.0f; }) );
+
+    for (int numThreads = 2; numThreads < 6; ++numThreads) {
+        sfz::Synth threadedSynth;
+        threadedSynth.setNumThreads(numThreads);
+        threadedSynth.setDeterministicRendering(true);
+        REQUIRE( renderNotes(threadedSynth) == serialOutput );
+    }
+}
+
+TEST_CASE("[Synth] Voice stealing at full polyphony")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/sine_and_kick.sfz");
+    const auto countVoices = [&](int channel, int noteNumber = -1) {
+        int count = 0;
+        for (int i = 0; i < synth.getNumVoices(); ++i) {
+            const auto* voice = synth.getVoiceView(i);
+            if (!voice->isFree() && voice->getTriggerChannel() == channel
+                && (noteNumber < 0 || voice->getTriggerNumber() == noteNumber))
+                count++;
+        }
+        return count;
+    };
+
+    // Fill the polyphony with generators, which never end on their own
+    for (int note = 0; note < synth.getNumVoices() - 4; ++note)
+        synth.noteOn(0, 1, note, 100);
+    for (int note = 0; note < 4; ++note)
+        synth.noteOn(0, 2, note, 100);
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+    synth.renderBlock(buffer);
+    REQUIRE( synth.getNumActiveVoices() == synth.getNumVoices() );
+
+    // Released voices are stolen first
+    for (int note = 0; note < 4; ++note)
+        synth.noteOff(0, 2, note, 0);
+    for (int note = 0; note < 4; ++note)
+        synth.noteOn(0, 3, note, 100);
+    synth.renderBlock(buffer);
+    REQUIRE( synth.getNumActiveVoices() == synth.getNumVoices() );
+    REQUIRE( countVoices(2) == 0 );
+    REQUIRE( countVoices(3) == 4 );
+    REQUIRE( countVoices(1) == synth.getNumVoices() - 4 );
+
+    // Then the oldest playing voices
+    synth.noteOn(0, 4, 10, 100);
+    synth.noteOn(0, 4, 11, 100);
+    synth.renderBlock(buffer);
+    REQUIRE( countVoices(4) == 2 );
+    REQUIRE( countVoices(1, 0) == 0 );
+    REQUIRE( countVoices(1, 1) == 0 );
+    REQUIRE( countVoices(1, 2) == 1 );
+    REQUIRE( countVoices(3) == 4 );
+
+    // Rendering keeps the stealing order consistent
+    synth.renderBlock(buffer);
+    synth.noteOn(0, 5, 20, 100);
+    synth.renderBlock(buffer);
+    REQUIRE( countVoices(1, 2) == 0 );
+    REQUIRE( synth.getNumActiveVoices() == synth.getNumVoices() );
+}
+
+TEST_CASE("[Synth] Number of voices")
+{
+    sfz::Synth synth;
+    REQUIRE( synth.getNumVoices() == sfz::config::numVoices );
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/sine_and_kick.sfz");
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+
+    synth.setNumVoices(16);
+    REQUIRE( synth.getNumVoices() == 16 );
+    for (int note = 0; note < 20; ++note)
+        synth.noteOn(0, 1, note, 100);
+    synth.renderBlock(buffer);
+    REQUIRE( synth.getNumActiveVoices() == 16 );
+    REQUIRE( std::any_of(buffer.channelReader(0), buffer.channelReaderEnd(0), [](float value) { return value != 0.0f; }) );
+
+    // Resizing stops every voice
+    synth.setNumVoices(256);
+    REQUIRE( synth.getNumVoices() == 256 );
+    REQUIRE( synth.getNumActiveVoices() == 0 );
+    for (int note = 0; note < 200; ++note)
+        synth.noteOn(0, 1, note % 128, 100);
+    synth.setSamplesPerBlock(2 * blockSize);
+    sfz::AudioBuffer<float> largeBuffer { 2, 2 * blockSize };
+    synth.renderBlock(largeBuffer);
+    REQUIRE( synth.getNumActiveVoices() == 200 );
+}
+
+TEST_CASE("[Synth] Events are processed in the order of their delay")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/sine_and_kick.sfz");
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+    const auto isPlaying = [&](int noteNumber) {
+        for (int i = 0; i < synth.getNumVoices(); ++i) {
+            const auto* voice = synth.getVoiceView(i);
+            if (!voice->isFree() && voice->getTriggerNumber() == noteNumber)
+                return true;
+        }
+        return false;
+    };
+
+    // Nothing happens until the next block
+    synth.noteOn(10, 1, 0, 100);
+    REQUIRE( !isPlaying(0) );
+    synth.renderBlock(buffer);
+    REQUIRE( isPlaying(0) );
+
+    // The note-off comes first in the block even if it was sent last
+    synth.noteOn(100, 1, 1, 100);
+    synth.noteOff(50, 1, 1, 0);
+    synth.renderBlock(buffer);
+    REQUIRE( isPlaying(1) );
+
+    // Events past the end of the block wait for the next ones
+    synth.noteOn(blockSize + 10, 1, 2, 100);
+    synth.renderBlock(buffer);
+    REQUIRE( !isPlaying(2) );
+    synth.renderBlock(buffer);
+    REQUIRE( isPlaying(2) );
+}
+
+TEST_CASE("[Synth] Events sent before loading a file are dropped")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/sine_and_kick.sfz");
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+
+    synth.noteOn(0, 1, 40, 100);
+    synth.cc(0, 1, 7, 20);
+    synth.noteOn(blockSize + 10, 1, 42, 100);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/sine_and_kick.sfz");
+    synth.renderBlock(buffer);
+    synth.renderBlock(buffer);
+    REQUIRE( synth.getNumActiveVoices() == 0 );
+}
+
+TEST_CASE("[Synth] Events sent from several threads")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/sine_and_kick.sfz");
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+
+    std::vector<std::thread> senders;
+    for (int thread = 0; thread < 4; ++thread)
+        senders.emplace_back([&synth, thread]() {
+            for (int note = 0; note < 8; ++note)
+                synth.noteOn(note, 1, thread * 8 + note, 100);
+        });
+    for (int block = 0; block < 8; ++block)
+        synth.renderBlock(buffer);
+    for (auto& sender : senders)
+        sender.join();
+    synth.renderBlock(buffer);
+    REQUIRE( synth.getNumActiveVoices() == 32 );
+}
+
+TEST_CASE("[Synth] Output does not depend on the host block size")
+{
+    const auto render = [](int hostBlockSize) {
+        sfz::Synth synth;
+        synth.setSamplesPerBlock(hostBlockSize);
+        synth.loadSfzFile(fs::current_path() / "tests/TestFiles/sine_and_kick.sfz");
+        synth.noteOn(10, 1, 40, 100);
+        synth.noteOn(300, 1, 45, 100);
+        synth.cc(500, 1, 7, 20);
+        synth.noteOff(700, 1, 40, 0);
+
+        sfz::AudioBuffer<float> buffer { 2, hostBlockSize };
+        std::vector<float> output;
+        for (int block = 0; block < 2048 / hostBlockSize; ++block) {
+            synth.renderBlock(buffer);
+            output.insert(output.end(), buffer.channelReader(0), buffer.channelReaderEnd(0));
+        }
+        return output;
+    };
+
+    const auto reference = render(1024);
+    REQUIRE( std::any_of(reference.begin(), reference.end(), [](float value) { return value != 0.0f; }) );
+    REQUIRE( render(256) == reference );
+    REQUIRE( render(64) == reference );
+}
+
+TEST_CASE("[Synth] Generators")
+{
+    const auto sfzFile = fs::temp_directory_path() / "sfizz_generators.sfz";
+    std::ofstream { sfzFile.string() } << "<region> key=60 sample=*sine\n"
+                                       << "<region> key=61 sample=*saw\n"
+                                       << "<region> key=62 sample=*square\n"
+                                       << "<region> key=63 sample=*triangle\n"
+                                       << "<region> key=64 sample=*noise\n"
+                                       << "<region> key=65 sample=*silence\n";
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(sfzFile);
+    fs::remove(sfzFile);
+    REQUIRE( synth.getNumRegions() == 6 );
+    REQUIRE( synth.getRegionView(1)->generator == SfzGenerator::saw );
+    REQUIRE( synth.getRegionView(5)->generator == SfzGenerator::silence );
+
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+    const auto isSilent = [&]() {
+        return std::all_of(buffer.channelReader(0), buffer.channelReaderEnd(0), [](float value) { return value == 0.0f; });
+    };
+    for (int note = 60; note < 66; ++note) {
+        synth.noteOn(0, 1, note, 100);
+        synth.renderBlock(buffer);
+        synth.renderBlock(buffer);
+        REQUIRE( isSilent() == (note == 65) );
+        synth.noteOff(0, 1, note, 0);
+        for (int block = 0; block < 50; ++block)
+            synth.renderBlock(buffer);
+        REQUIRE( synth.getNumActiveVoices() == 0 );
+    }
+}
+
+TEST_CASE("[Synth] Silence gate")
+{
+    const auto sfzFile = fs::temp_directory_path() / "sfizz_silence_gate.sfz";
+    std::ofstream { sfzFile.string() } << "<region> key=60 sample=*silence ampeg_release=10\n"
+                                       << "<region> key=61 sample=*sine ampeg_release=10\n";
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(sfzFile);
+    fs::remove(sfzFile);
+
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+    const int quantaPerBlock = blockSize / sfz::config::renderQuantum;
+    const auto renderQuanta = [&](int numQuanta) {
+        for (int block = 0; block < (numQuanta + quantaPerBlock - 1) / quantaPerBlock; ++block)
+            synth.renderBlock(buffer);
+    };
+
+    // Held notes are never gated, even when silent
+    synth.noteOn(0, 1, 60, 100);
+    renderQuanta(4 * sfz::config::silenceQuanta);
+    REQUIRE( synth.getNumActiveVoices() == 1 );
+
+    // A silent release tail is freed long before the end of its envelope
+    synth.noteOff(0, 1, 60, 0);
+    renderQuanta(sfz::config::silenceQuanta + 1);
+    REQUIRE( synth.getNumActiveVoices() == 0 );
+    REQUIRE( synth.getNumSilentVoicesFreed() == 1 );
+
+    // An audible release tail keeps playing
+    synth.noteOn(0, 1, 61, 100);
+    renderQuanta(1);
+    synth.noteOff(0, 1, 61, 0);
+    renderQuanta(4 * sfz::config::silenceQuanta);
+    REQUIRE( synth.getNumActiveVoices() == 1 );
+    REQUIRE( synth.getNumSilentVoicesFreed() == 1 );
+
+    // The gate can be disabled
+    synth.setSilenceGate(sfz::config::silenceThreshold, 0);
+    synth.noteOn(0, 1, 60, 100);
+    synth.noteOff(10, 1, 60, 0);
+    renderQuanta(4 * sfz::config::silenceQuanta);
+    REQUIRE( synth.getNumActiveVoices() == 2 );
+    REQUIRE( synth.getNumSilentVoicesFreed() == 1 );
+}
+
+// Writes a mono 16 bit file of pseudo-random frames
+static void writeNoiseWave(const fs::path& path, int numFrames, int sampleRate)
+{
+    std::vector<short> frames(numFrames);
+    uint32_t state { 1 };
+    for (auto& frame : frames) {
+        state = state * 1664525 + 1013904223;
+        frame = static_cast<short>(state >> 20);
+    }
+    writeWave(path, frames, sampleRate);
+}
+
+// Wait until the loading thread holds the next frames of every voice, so that the
+// rendering does not depend on how fast the thread runs
+static bool waitForVoiceData(const sfz::Synth& synth, int numFrames)
+{
+    for (int i = 0; i < 1000; ++i) {
+        bool ready { true };
+        for (int voice = 0; voice < synth.getNumVoices(); ++voice)
+            ready = ready && synth.getVoiceView(voice)->hasDataFor(numFrames);
+        if (ready)
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+TEST_CASE("[Synth] Streaming samples longer than the preloaded data")
+{
+    const auto directory = fs::temp_directory_path();
+    const auto wavFile = directory / "sfizz_streaming.wav";
+    const auto sfzFile = directory / "sfizz_streaming.sfz";
+    constexpr int numFrames { 4 * sfz::config::preloadSize };
+    writeNoiseWave(wavFile, numFrames, 48000);
+    // The looping region loads the whole file instead of streaming it; its loop
+    // ends with the sample, so that both regions play the same frames
+    std::ofstream { sfzFile.string() } << "<region> key=60 pitch_keycenter=60 sample=" << wavFile.filename().string() << "\n"
+                                       << "<region> key=62 pitch_keycenter=62 sample=" << wavFile.filename().string()
+                                       << " loop_mode=loop_continuous loop_start=0 loop_end=" << numFrames - 1 << "\n";
+    sfz::Synth synth;
+    synth.setSampleRate(48000);
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(sfzFile);
+    fs::remove(sfzFile);
+
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+    const auto render = [&](int noteNumber) {
+        std::vector<float> output;
+        synth.noteOn(0, 1, noteNumber, 100);
+        for (int block = 0; block < (numFrames - blockSize) / blockSize; ++block) {
+            REQUIRE( waitForVoiceData(synth, blockSize) );
+            synth.renderBlock(buffer);
+            output.insert(output.end(), buffer.channelReader(0), buffer.channelReader(0) + blockSize);
+        }
+        synth.noteOff(0, 1, noteNumber, 0);
+        synth.renderBlock(buffer);
+        return output;
+    };
+
+    const auto streamed = render(60);
+    const auto loaded = render(62);
+    REQUIRE( synth.getNumStreamUnderruns() == 0 );
+    REQUIRE( streamed == loaded );
+    REQUIRE( std::any_of(streamed.end() - blockSize, streamed.end(), [](float x) { return x != 0.0f; }) );
+    fs::remove(wavFile);
+}
+
+TEST_CASE("[Synth] Memory mapped streaming")
+{
+    const auto directory = fs::temp_directory_path();
+    const auto wavFile = directory / "sfizz_mapped_streaming.wav";
+    const auto sfzFile = directory / "sfizz_mapped_streaming.sfz";
+    constexpr int numFrames { 2 * sfz::config::preloadSize };
+    writeNoiseWave(wavFile, numFrames, 48000);
+    std::ofstream { sfzFile.string() } << "<region> sample=" << wavFile.filename().string() << "\n";
+    sfz::Synth synth;
+    synth.setSampleRate(48000);
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(sfzFile);
+    fs::remove(sfzFile);
+
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+    const auto render = [&](bool memoryMapped) {
+        std::vector<float> output;
+        synth.setMemoryMappedStreaming(memoryMapped);
+        synth.noteOn(0, 1, 60, 100);
+        for (int block = 0; block < numFrames / blockSize; ++block) {
+            REQUIRE( waitForVoiceData(synth, blockSize) );
+            synth.renderBlock(buffer);
+            output.insert(output.end(), buffer.channelReader(0), buffer.channelReader(0) + blockSize);
+        }
+        return output;
+    };
+
+    // The voice releases itself at the end of the sample
+    const auto mapped = render(true);
+    const auto read = render(false);
+    REQUIRE( synth.getNumStreamUnderruns() == 0 );
+    REQUIRE( mapped == read );
+    fs::remove(wavFile);
+}
+
+TEST_CASE("[Synth] Streams keep playing when the block size changes")
+{
+    const auto directory = fs::temp_directory_path();
+    const auto wavFile = directory / "sfizz_streaming_block_size.wav";
+    const auto sfzFile = directory / "sfizz_streaming_block_size.sfz";
+    constexpr int numFrames { 4 * sfz::config::preloadSize };
+    writeNoiseWave(wavFile, numFrames, 48000);
+    std::ofstream { sfzFile.string() } << "<region> sample=" << wavFile.filename().string() << "\n";
+
+    const auto render = [&](bool changeSettings) {
+        sfz::Synth synth;
+        synth.setSampleRate(48000);
+        synth.setSamplesPerBlock(blockSize);
+        synth.loadSfzFile(sfzFile);
+        synth.noteOn(0, 1, 60, 100);
+
+        sfz::AudioBuffer<float> buffer { 2, 2 * blockSize };
+        std::vector<float> output;
+        int size { blockSize };
+        for (int frame = 0; frame < numFrames - 2 * blockSize; frame += size) {
+            if (changeSettings && frame == 2 * sfz::config::preloadSize) {
+                // The same size, then a larger one that still fits in the streams
+                synth.setSamplesPerBlock(size);
+                size = 2 * blockSize;
+                synth.setSamplesPerBlock(size);
+            }
+            // Twice the default lookahead, so that the streams have to grow
+            if (changeSettings && frame == 3 * sfz::config::preloadSize)
+                synth.setStreamingLookahead(2 * sfz::config::streamingBlocks * sfz::config::defaultSamplesPerBlock / size);
+
+            REQUIRE( waitForVoiceData(synth, size) );
+            auto block = sfz::AudioSpan<float>(buffer).first(size);
+            synth.renderBlock(block);
+            output.insert(output.end(), buffer.channelReader(0), buffer.channelReader(0) + size);
+        }
+        REQUIRE( synth.getNumActiveVoices() == 1 );
+        REQUIRE( synth.getNumStreamUnderruns() == 0 );
+        return output;
+    };
+
+    const auto reference = render(false);
+    REQUIRE( std::any_of(reference.end() - blockSize, reference.end(), [](float x) { return x != 0.0f; }) );
+    REQUIRE( render(true) == reference );
+    fs::remove(sfzFile);
+    fs::remove(wavFile);
+}
+
+TEST_CASE("[Synth] Decoded files are shared between notes")
+{
+    const auto directory = fs::temp_directory_path();
+    const auto wavFile = directory / "sfizz_file_cache.wav";
+    const auto sfzFile = directory / "sfizz_file_cache.sfz";
+    constexpr int numFrames { 2 * sfz::config::preloadSize };
+    writeNoiseWave(wavFile, numFrames, 48000);
+    // Looping regions are loaded whole rather than streamed
+    std::ofstream { sfzFile.string() } << "<region> sample=" << wavFile.filename().string()
+                                       << " loop_mode=loop_continuous loop_start=0 loop_end=" << numFrames - 1 << "\n";
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(blockSize);
+    synth.loadSfzFile(sfzFile);
+    fs::remove(sfzFile);
+
+    sfz::AudioBuffer<float> buffer { 2, blockSize };
+    const auto waitFor = [&](auto condition) {
+        for (int i = 0; i < 200 && !condition(); ++i) {
+            synth.renderBlock(buffer);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return condition();
+    };
+
+    for (int note = 60; note < 63; ++note) {
+        synth.noteOn(0, 1, note, 100);
+        REQUIRE( waitFor([&] { auto statistics = synth.getFileCacheStatistics(); return statistics.hits + statistics.misses == note - 59; }) );
+    }
+    auto statistics = synth.getFileCacheStatistics();
+    REQUIRE( statistics.misses == 1 );
+    REQUIRE( statistics.hits == 2 );
+    REQUIRE( statistics.numBytes >= (numFrames - 1) * sizeof(float) );
+
+    // Files are only evicted once no voice plays them anymore
+    synth.setFileCacheSize(0);
+    synth.noteOff(0, 1, 60, 0);
+    synth.noteOff(0, 1, 61, 0);
+    REQUIRE( waitFor([&] { return synth.getNumActiveVoices() == 1; }) );
+    REQUIRE( synth.getFileCacheStatistics().evictions == 0 );
+    synth.noteOff(0, 1, 62, 0);
+    REQUIRE( waitFor([&] { return synth.getFileCacheStatistics().evictions == 1; }) );
+    REQUIRE( synth.getFileCacheStatistics().numBytes == 0 );
+    fs::remove(wavFile);
+}
+
+TEST_CASE("[Synth] Samples are scanned once over several threads")
+{
+    const auto directory = fs::temp_directory_path();
+    const auto sfzFile = directory / "sfizz_scan.sfz";
+    constexpr int numFiles { 8 };
+    constexpr int numFrames { 2 * sfz::config::preloadSize };
+    constexpr int offset { 1000 };
+    std::ofstream sfz { sfzFile.string() };
+    for (int i = 0; i < numFiles; ++i) {
+        const auto wavFile = "sfizz_scan_" + std::to_string(i) + ".wav";
+        writeNoiseWave(directory / wavFile, numFrames, 48000);
+        sfz << "<region> key=" << i << " sample=" << wavFile << "\n"
+            << "<region> key=" << i << " sample=" << wavFile << " offset=" << offset << "\n";
+    }
+    sfz << "<region> sample=sfizz_scan_missing.wav\n";
+    sfz.close();
+
+    for (int numThreads : { 1, 3 }) {
+        sfz::Synth synth;
+        synth.setNumLoadingThreads(numThreads);
+        synth.loadSfzFile(sfzFile);
+        REQUIRE( synth.getNumRegions() == 2 * numFiles );
+        REQUIRE( synth.getNumPreloadedSamples() == numFiles );
+        // Both regions of a sample share the preloaded data of the largest offset
+        for (int i = 0; i < synth.getNumRegions(); ++i) {
+            const auto* region = synth.getRegionView(i);
+            REQUIRE( region->sampleEnd == numFrames );
+            REQUIRE( region->preloadedData->getNumFrames() == offset + sfz::config::preloadSize );
+            for (int j = 0; j < synth.getNumRegions(); ++j) {
+                const auto* other = synth.getRegionView(j);
+                if (other->sample == region->sample)
+                    REQUIRE( other->preloadedData == region->preloadedData );
+            }
+        }
+    }
+
+    fs::remove(sfzFile);
+    for (int i = 0; i < numFiles; ++i)
+        fs::remove(directory / ("sfizz_scan_" + std::to_string(i) + ".wav"));
+}
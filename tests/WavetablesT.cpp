@@ -0,0 +1,83 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Wavetables.h"
+#include "MathHelpers.h"
+#include "catch2/catch.hpp"
+#include <algorithm>
+#include <cmath>
+using namespace Catch::literals;
+
+namespace {
+constexpr int tableSize { sfz::WavetableBank::tableSize };
+constexpr int quarter { tableSize / 4 };
+}
+
+TEST_CASE("[Wavetables] Waveforms")
+{
+    const auto& bank = sfz::WavetableBank::get();
+    const auto sine = bank.getTable(SfzGenerator::sine, 1.0f);
+    REQUIRE( sine.size() == tableSize + 1 );
+    REQUIRE( sine[0] == Approx(0.0f).margin(1e-6) );
+    REQUIRE( sine[quarter] == Approx(1.0f) );
+    REQUIRE( sine[3 * quarter] == Approx(-1.0f) );
+    REQUIRE( sine[tableSize] == sine[0] );
+
+    const auto triangle = bank.getTable(SfzGenerator::triangle, 1.0f);
+    REQUIRE( triangle[quarter] == Approx(1.0f).margin(1e-3) );
+    REQUIRE( triangle[quarter / 2] == Approx(0.5f).margin(1e-3) );
+    REQUIRE( triangle[3 * quarter] == Approx(-1.0f).margin(1e-3) );
+
+    const auto square = bank.getTable(SfzGenerator::square, 1.0f);
+    REQUIRE( square[quarter] == Approx(1.0f).margin(1e-2) );
+    REQUIRE( square[3 * quarter] == Approx(-1.0f).margin(1e-2) );
+
+    const auto saw = bank.getTable(SfzGenerator::saw, 1.0f);
+    REQUIRE( saw[quarter] == Approx(0.5f).margin(1e-2) );
+    REQUIRE( saw[3 * quarter] == Approx(-0.5f).margin(1e-2) );
+    REQUIRE( saw[tableSize] == saw[0] );
+}
+
+TEST_CASE("[Wavetables] Band limiting")
+{
+    const auto& bank = sfz::WavetableBank::get();
+    // Faster playback gets tables with fewer harmonics, down to a sine
+    REQUIRE( bank.getTable(SfzGenerator::saw, 1.0f).data() == bank.getTable(SfzGenerator::saw, 0.1f).data() );
+    REQUIRE( bank.getTable(SfzGenerator::saw, 1.5f).data() != bank.getTable(SfzGenerator::saw, 1.0f).data() );
+    REQUIRE( bank.getTable(SfzGenerator::saw, 1.5f).data() == bank.getTable(SfzGenerator::saw, 2.0f).data() );
+
+    const auto fundamental = bank.getTable(SfzGenerator::square, tableSize / 2);
+    for (int n = 0; n < tableSize; n += 64)
+        REQUIRE( fundamental[n] == Approx(4.0 / pi<double> * std::sin(twoPi<double> * n / tableSize)).margin(1e-5) );
+
+    // The saw table read with a step of 4 has no harmonic above tableSize / 8
+    const auto saw = bank.getTable(SfzGenerator::saw, 4.0f);
+    double highest { 0.0 };
+    for (int h = tableSize / 8 + 1; h < tableSize / 2; h += 7) {
+        double correlation { 0.0 };
+        for (int n = 0; n < tableSize; ++n)
+            correlation += saw[n] * std::sin(twoPi<double> * h * n / tableSize);
+        highest = std::max(highest, std::abs(correlation) * 2 / tableSize);
+    }
+    REQUIRE( highest < 1e-5 );
+}